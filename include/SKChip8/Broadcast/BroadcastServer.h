@@ -0,0 +1,84 @@
+#ifndef _CHIP8_BROADCAST_SERVER_H_
+#define _CHIP8_BROADCAST_SERVER_H_
+
+#include "FrameCodec.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // streams encoded frames to any number of local subscribers over a Unix
+    // domain socket or TCP (POSIX only). every subscriber queues references to
+    // the same encoded buffers, so the per-client cost is only the send() call.
+    // single threaded: call Publish once per frame and Pump regularly
+    class BroadcastServer
+    {
+    public:
+        // subscribers that fall this many messages behind are disconnected
+        static constexpr size_t MAX_CLIENT_BACKLOG = 240;
+
+        // listens on a Unix domain socket at path, replacing any stale socket file
+        explicit BroadcastServer(const std::string &unixPath);
+        // listens on 127.0.0.1:port
+        explicit BroadcastServer(uint16_t tcpPort);
+        ~BroadcastServer();
+
+        BroadcastServer(const BroadcastServer &) = delete;
+        BroadcastServer &operator=(const BroadcastServer &) = delete;
+
+        // queues a message for every subscriber. the messages since the last
+        // keyframe are kept so that late joiners can start right away
+        void Publish(const EncodedFrame &message, bool keyframe);
+
+        // accepts new subscribers and writes as much queued data as the
+        // sockets will take without blocking
+        void Pump();
+
+        size_t GetClientCount() const { return clients_.size(); }
+
+    private:
+        struct Client
+        {
+            int Fd;
+            std::deque<EncodedFrame> Queue;
+            // bytes of Queue.front() already sent
+            size_t Offset;
+        };
+
+        void acceptClients();
+        // returns false if the client should be dropped
+        bool flush(Client &client);
+
+        int listenFd_;
+        std::string unixPath_;
+        std::vector<Client> clients_;
+        std::vector<EncodedFrame> sinceKeyframe_;
+    };
+
+    // blocking subscriber side of BroadcastServer
+    class BroadcastClient
+    {
+    public:
+        explicit BroadcastClient(const std::string &unixPath);
+        BroadcastClient(const std::string &host, uint16_t tcpPort);
+        ~BroadcastClient();
+
+        BroadcastClient(const BroadcastClient &) = delete;
+        BroadcastClient &operator=(const BroadcastClient &) = delete;
+
+        // waits for the next message and applies it to decoder. returns false
+        // once the server goes away
+        bool Receive(FrameDecoder &decoder);
+
+    private:
+        bool readExactly(uint8_t *data, size_t size);
+
+        int fd_;
+        std::vector<uint8_t> message_;
+    };
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef _CHIP8_FRAME_CODEC_H_
+#define _CHIP8_FRAME_CODEC_H_
+
+#include <Core/CPU.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SKChip8
+{
+    // wire format of a broadcast frame, all integers little endian:
+    //   u32 payload size (excluding these 4 bytes)
+    //   u8  message type (keyframe or delta)
+    //   u32 frame number
+    //   u8  sound timer
+    //   u32 changed row mask, bit n is framebuffer row n
+    //   ... XOR delta of the changed rows (see DeltaCodec.h). keyframes
+    //       carry every row XORed against an empty screen
+    static constexpr size_t FRAME_HEADER_SIZE = 4 + 1 + 4 + 1 + 4;
+    static constexpr size_t FRAME_ROW_BYTES = SCR_WIDTH / 8;
+
+    enum class FrameMessageType : uint8_t
+    {
+        Keyframe = 1,
+        Delta = 2
+    };
+
+    using EncodedFrame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // turns successive framebuffers into messages. each message is encoded
+    // once and can be shared by any number of subscribers
+    class FrameEncoder
+    {
+    public:
+        // a keyframe is emitted every keyframeInterval frames
+        explicit FrameEncoder(uint32_t keyframeInterval = 60);
+
+        EncodedFrame Encode(const CPU &cpu);
+
+        // the last message returned by Encode was a keyframe
+        bool LastWasKeyframe() const { return lastWasKeyframe_; }
+
+    private:
+        uint32_t keyframeInterval_;
+        uint32_t frame_;
+        bool lastWasKeyframe_;
+        CPU::PackedFrameBuffer previous_;
+        std::vector<uint8_t> rows_;
+    };
+
+    // rebuilds the framebuffer from a message stream. deltas are ignored
+    // until the first keyframe arrives
+    class FrameDecoder
+    {
+    public:
+        FrameDecoder();
+
+        // applies one complete message (including the size prefix). returns
+        // false if it is malformed
+        bool Apply(const uint8_t *message, size_t size);
+
+        bool HasKeyframe() const { return hasKeyframe_; }
+        uint32_t GetFrame() const { return frame_; }
+        uint8_t GetSoundTimer() const { return soundTimer_; }
+        const CPU::PackedFrameBuffer &GetPackedFrameBuffer() const { return frameBuffer_; }
+
+    private:
+        bool hasKeyframe_;
+        uint32_t frame_;
+        uint8_t soundTimer_;
+        CPU::PackedFrameBuffer frameBuffer_;
+        std::vector<uint8_t> rows_;
+    };
+}
+
+#endif
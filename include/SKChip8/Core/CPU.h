@@ -2,11 +2,16 @@
 #define _CHIP8_CPU_H_
 
 #include "Utils/CHIP8ISA.h"
+#include "Utils/Hash.h"
+#include "ExecutionProfile.h"
+#include "CallGraphProfile.h"
+#include "MemoryHeatmap.h"
 
 #include <memory>
 #include <cstdint>
+#include <array>
+#include <string>
 #include <vector>
-#include <stack>
 #include <chrono>
 #include <mutex>
 #include <thread>
@@ -19,43 +24,130 @@ namespace SKChip8
     static constexpr uint16_t CHIP8_REG_BITS = 12;
     static constexpr uint16_t CHIP8_MEM_SIZE = 1 << 12;
     static constexpr uint16_t PROG_MEMORY_OFFSET = 0x200;
+    static constexpr uint16_t MAX_ROM_SIZE = CHIP8_MEM_SIZE - PROG_MEMORY_OFFSET;
     static constexpr uint8_t SCR_HEIGHT = 32;
     static constexpr uint8_t SCR_WIDTH = 64;
     static constexpr size_t KEY_COUNT = 16;
     static constexpr uint16_t FONT_MEMORY_OFFSET = 0x000;
     static constexpr uint16_t FRAME_BUFFER_SIZE = (SCR_WIDTH / 8) * SCR_HEIGHT;
+    static constexpr size_t STACK_DEPTH = 16;
+    // memory is hashed in pages so that only written pages need rehashing
+    static constexpr uint16_t MEMORY_PAGE_SIZE = 0x100;
+    static constexpr size_t MEMORY_PAGE_COUNT = CHIP8_MEM_SIZE / MEMORY_PAGE_SIZE;
 
     // timer period (60Hz)
     static constexpr auto TIMER_PERIOD = 16.67ms;
     static constexpr auto TIMER_HZ = 60.0;
 
+    // a span of memory an instruction reads or writes
+    struct MemoryAccess
+    {
+        uint16_t Address;
+        uint16_t Size;
+        bool Write;
+    };
+    // the fetch plus at most one sprite, BCD or register load/store
+    static constexpr size_t MAX_MEMORY_ACCESSES = 2;
+
+    // the CPU holds no pointers or heap-allocated members so that copying it
+    // (e.g. to fork a running machine) is a plain memberwise copy
     class CPU
     {
     public:
         CPU();
 
-        // loads a program ROM into the code region
-        void LoadROM(std::vector<uint8_t> buffer);
+        // loads a program ROM into the code region, throws if it is larger
+        // than MAX_ROM_SIZE. the bytes are copied, the caller keeps them
+        void LoadROM(const uint8_t *data, size_t size);
+        void LoadROM(const std::vector<uint8_t> &buffer) { LoadROM(buffer.data(), buffer.size()); }
 
         // updates state by one cycle
         void Cycle();
 
-        // set the key state
+        // set the key state. a change wakes a CPU halted on FX0A
         void SetKeyState(uint8_t key, bool state);
 
+        // reseeds the generator used by RegisterMaskedRandom
+        void SeedRandom(uint32_t seed);
+
         using FrameBuffer = std::array<std::array<bool, SCR_WIDTH>, SCR_HEIGHT>;
         FrameBuffer GetFrameBuffer() const;
 
+        // the framebuffer in its native packed format, one bit per pixel
+        using PackedFrameBuffer = std::array<uint8_t, FRAME_BUFFER_SIZE>;
+        const PackedFrameBuffer &GetPackedFrameBuffer() const { return frameBuffer_; }
+
         std::string DumpState() const;
 
+        // hash over the architectural state: memory, registers, I, PC, stack,
+        // timers, framebuffer, halt state and RNG. the cycle counter and the
+        // keyboard are left out so that equivalent machines reached through
+        // different inputs hash the same.
+        // not thread-safe despite being const: it refreshes the cached page
+        // hashes, so two threads must not hash the same CPU at once. give
+        // each thread its own copy (copies are cheap) instead
+        Hash128 StateHash() const;
+
+        // size of the binary state written by SaveState
+        static constexpr size_t STATE_SIZE = CHIP8_MEM_SIZE + FRAME_BUFFER_SIZE + REG_COUNT + KEY_COUNT +
+                                             2 * STACK_DEPTH + 1 + // call stack and stack pointer
+                                             2 + 2 + 1 +           // I, PC, PC increment flag
+                                             1 + 1 + 1 + 1 +       // timers, halt state, awaited register
+                                             4 + 8 + 1;            // RNG, cycle counter, external state
+
+        // copies the complete state to/from STATE_SIZE bytes. multi-byte values
+        // are stored little endian so states are portable between hosts.
+        // LoadState throws, leaving the CPU untouched, if PC, I or a return
+        // address on the stack lies outside memory
+        void SaveState(uint8_t *out) const;
+        void LoadState(const uint8_t *in);
+
+        // appends to out what the next Cycle() will overwrite: the registers,
+        // timers and other scalars, plus the memory, framebuffer and stack
+        // bytes the instruction at PC can write. ApplyUndo(out) after that
+        // Cycle() puts the CPU back exactly as it was
+        void RecordUndo(std::vector<uint8_t> &out) const;
+        // throws if record isn't something RecordUndo produced
+        void ApplyUndo(const uint8_t *record, size_t size);
+
+        // the memory the next Cycle() touches: the instruction fetch and
+        // whatever DXYN, FX33, FX55 or FX65 reads or writes at I. nothing
+        // while halted waiting for a key. returns the number of entries used
+        size_t PendingMemoryAccesses(std::array<MemoryAccess, MAX_MEMORY_ACCESSES> &out) const;
+
         // Updates the timers by one tick
         void TimerTick();
 
+#ifdef SKCHIP8_PROFILING
+        // executions since the CPU was created or the profile was cleared
+        const ExecutionProfile &GetProfile() const { return profile_; }
+        // instructions per subroutine, by CALL target
+        const CallGraphProfile &GetCallGraph() const { return callGraph_; }
+        // fetches, sprite and register loads, BCD and register stores per address
+        const MemoryHeatmap &GetHeatmap() const { return heatmap_; }
+        void DecayHeatmap() { heatmap_.Decay(); }
+        // clears every profile and the heatmap
+        void ClearProfile()
+        {
+            profile_.Clear();
+            callGraph_.Clear();
+            heatmap_.Clear();
+        }
+#endif
+
+        // number of cycles executed since the CPU was created, including
+        // cycles spent halted on FX0A
+        uint64_t GetCycleCount() const { return systemClock_; }
+        // waiting for a key press (FX0A), cycles pass without executing anything
+        bool IsHalted() const { return halted_; }
+        // number of instructions executed since the CPU was created, excluding
+        // cycles spent halted. a performance counter: not saved, hashed or journaled
+        uint64_t GetInstructionCount() const { return instructionCount_; }
         uint16_t GetPC() const { return programCounter_; }
         uint16_t GetCurrentInstruction() const { return currentInstruction(); }
-        std::array<uint8_t, CHIP8_MEM_SIZE> GetMemory() const { return memory_; }
-        std::array<uint8_t, REG_COUNT> GetRegisters() const { return registerFile_; }
-        std::array<bool, KEY_COUNT> GetKeyState() const { return keyState_; }
+        const std::array<uint8_t, CHIP8_MEM_SIZE> &GetMemory() const { return memory_; }
+        const std::array<uint8_t, REG_COUNT> &GetRegisters() const { return registerFile_; }
+        const std::array<bool, KEY_COUNT> &GetKeyState() const { return keyState_; }
         uint8_t GetDelayTimer() const { return delayTimer_; }
         uint8_t GetSoundTimer() const { return soundTimer_; }
         uint16_t GetIndexPointer() const { return indexRegister_; }
@@ -70,6 +162,9 @@ namespace SKChip8
 
         void drawSprite(uint8_t x, uint8_t y, uint8_t n);
 
+        void pushStack(uint16_t address);
+        uint16_t popStack();
+
         std::string dumpSpecial() const;
         std::string dumpRegisters() const;
         std::string dumpMemory() const;
@@ -77,8 +172,25 @@ namespace SKChip8
         std::string dumpStack() const;
         std::string dumpKeyboard() const;
 
+        // xorshift32, kept in the CPU so that copies diverge deterministically
+        uint8_t nextRandom();
+
+        // must be called whenever memory in [address, address + size) is written
+        void markMemoryDirty(uint16_t address, uint16_t size);
+
+        // spans of an undo record, see RecordUndo
+        enum class UndoTarget : uint8_t
+        {
+            Memory,
+            FrameBuffer,
+            Stack
+        };
+        static constexpr size_t UNDO_SCALARS_SIZE = REG_COUNT + KEY_COUNT + 2 + 2 + 1 + 1 + 4 + 4 + 8 + 1;
+        static constexpr size_t UNDO_SPAN_HEADER_SIZE = 1 + 2 + 2;
+        void recordUndoSpan(std::vector<uint8_t> &out, UndoTarget target, size_t offset, size_t size) const;
+
     private:
-        // true if the keyboard changed state since the last cycle
+        // true if a key changed state since a halted cycle last looked
         bool isKeyboardDirty() const { return externState_ & KEYBOARD_DIRTY_BIT; }
 
         constexpr size_t flattenedFrameBufferIndex(uint8_t x, uint8_t y) const { return (SCR_WIDTH / 8) * y + (x / 8); }
@@ -89,13 +201,16 @@ namespace SKChip8
         // actually only 12 bits due to the memory capacity of chip-8
         uint16_t indexRegister_;
         uint64_t systemClock_;
+        uint64_t instructionCount_;
         uint16_t programCounter_;
         bool shouldIncrementPC_;
 
         // framebuffer in a row-major packed format
         // pixel (x, y) occurs at A[(SCR_WIDTH/8)*y + (x/8)] >> (8 - (x % 8))
         std::array<uint8_t, FRAME_BUFFER_SIZE> frameBuffer_;
-        std::stack<uint16_t> callStack_;
+        std::array<uint16_t, STACK_DEPTH> callStack_;
+        // number of entries in use in callStack_
+        uint8_t stackPointer_;
 
         std::array<bool, KEY_COUNT> keyState_;
 
@@ -110,9 +225,23 @@ namespace SKChip8
         uint8_t delayTimer_;
         uint8_t soundTimer_;
 
+        uint32_t randomState_;
+
+        // cached per-page memory hashes, refreshed lazily by StateHash.
+        // written from a const method, see the thread-safety note there
+        mutable std::array<Hash128, MEMORY_PAGE_COUNT> memoryPageHashes_;
+        mutable uint16_t dirtyMemoryPages_;
+
         // state updated async to cpu clock cycles (e.g. keyboard)
         uint8_t externState_;
-        static constexpr uint8_t KEYBOARD_DIRTY_BIT = 0;
+        static constexpr uint8_t KEYBOARD_DIRTY_BIT = 1 << 0;
+
+#ifdef SKCHIP8_PROFILING
+        // not part of the machine state: never saved, hashed or journaled
+        ExecutionProfile profile_;
+        CallGraphProfile callGraph_;
+        MemoryHeatmap heatmap_;
+#endif
     };
 }
 #endif
@@ -0,0 +1,80 @@
+#ifndef _CHIP8_CALL_GRAPH_PROFILE_H_
+#define _CHIP8_CALL_GRAPH_PROFILE_H_
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace SKChip8
+{
+    // nodes of the call tree, calls past this many distinct paths are
+    // attributed to the deepest caller already in the tree
+    static constexpr size_t CALL_GRAPH_NODE_COUNT = 1024;
+
+    // instructions per subroutine, collected by CPU::Cycle alongside the
+    // ExecutionProfile in builds configured with SKCHIP8_PROFILING.
+    // subroutines are identified by their CALL target and tracked as a call
+    // tree so that every call path keeps its own counts. the tree lives in a
+    // fixed array so the CPU stays free of heap members
+    struct CallGraphProfile
+    {
+        // node 0 stands for the code outside any subroutine
+        static constexpr uint16_t ROOT = 0;
+        static constexpr uint16_t NONE = 0xFFFF;
+
+        struct Node
+        {
+            uint16_t Address;
+            uint16_t Parent;
+            uint16_t FirstChild;
+            uint16_t NextSibling;
+            uint64_t Calls;
+            // instructions executed in this routine on this path, not counting callees
+            uint64_t ExclusiveCycles;
+        };
+
+        // totals over every path a subroutine was called on. inclusive
+        // cycles count recursive calls once
+        struct SubroutineStats
+        {
+            uint16_t Address;
+            uint64_t Calls;
+            uint64_t InclusiveCycles;
+            uint64_t ExclusiveCycles;
+        };
+
+        std::array<Node, CALL_GRAPH_NODE_COUNT> Nodes;
+        uint16_t NodeCount;
+        uint16_t Current;
+        // calls made while the tree was full, unwound before leaving Current
+        uint16_t OverflowDepth;
+
+        CallGraphProfile() { Clear(); }
+
+        void Clear();
+
+        // one instruction in the current routine
+        void Tick() { Nodes[Current].ExclusiveCycles++; }
+
+        // a CALL to address
+        void Enter(uint16_t address);
+
+        // a RET, ignored at the root. restoring a state or undoing
+        // instructions can leave the tree deeper or shallower than the real
+        // stack, the profile simply keeps attributing to Current
+        void Leave();
+
+        uint64_t GetTotalCycles() const;
+
+        // one entry per called address plus the root, by address
+        std::vector<SubroutineStats> GetSubroutineStats() const;
+
+        // collapsed stacks, one line per path that executed instructions:
+        //   0x200;0x2A4;0x310 1234
+        // as read by flamegraph.pl, inferno and speedscope
+        void WriteCollapsed(std::ostream &os) const;
+    };
+}
+
+#endif
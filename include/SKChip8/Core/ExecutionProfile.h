@@ -0,0 +1,57 @@
+#ifndef _CHIP8_EXECUTION_PROFILE_H_
+#define _CHIP8_EXECUTION_PROFILE_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace SKChip8
+{
+    // opcodes are grouped by their top nibble, which is what CPU::Cycle
+    // dispatches on
+    static constexpr size_t OPCODE_CLASS_COUNT = 16;
+    static constexpr size_t PROFILE_PC_COUNT = 1 << 12;
+
+    // execution counts collected by CPU::Cycle in builds configured with
+    // SKCHIP8_PROFILING. without it the CPU has no profile and Cycle does no
+    // extra work at all
+    struct ExecutionProfile
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::array<uint64_t, OPCODE_CLASS_COUNT> ClassCounts;
+        // host time spent decoding and executing each class
+        std::array<uint64_t, OPCODE_CLASS_COUNT> ClassNanoseconds;
+        std::array<uint64_t, PROFILE_PC_COUNT> PCCounts;
+
+        ExecutionProfile() { Clear(); }
+
+        void Clear()
+        {
+            ClassCounts.fill(0);
+            ClassNanoseconds.fill(0);
+            PCCounts.fill(0);
+        }
+
+        void Record(uint16_t pc, uint16_t opcode, Clock::duration elapsed)
+        {
+            const auto opcodeClass = opcode >> 12;
+            ClassCounts[opcodeClass]++;
+            ClassNanoseconds[opcodeClass] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            PCCounts[pc % PROFILE_PC_COUNT]++;
+        }
+
+        uint64_t GetTotalCount() const;
+
+        // mnemonic summary of a class, e.g. "DRW" for 0xD
+        static const char *ClassName(size_t opcodeClass);
+
+        // one row per class and per executed PC:
+        //   kind,id,name,count,total_ns
+        // kind is "class" or "pc", id is the class nibble or the address in hex
+        void WriteCSV(std::ostream &os) const;
+    };
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef _CHIP8_MEMORY_HEATMAP_H_
+#define _CHIP8_MEMORY_HEATMAP_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace SKChip8
+{
+    static constexpr size_t HEATMAP_SIZE = 1 << 12;
+
+    // per-address access counters collected by CPU::Cycle in builds
+    // configured with SKCHIP8_PROFILING. addresses that are both written and
+    // executed are self-modifying code
+    struct MemoryHeatmap
+    {
+        std::array<uint32_t, HEATMAP_SIZE> Reads;
+        std::array<uint32_t, HEATMAP_SIZE> Writes;
+        std::array<uint32_t, HEATMAP_SIZE> Executes;
+
+        MemoryHeatmap() { Clear(); }
+
+        void Clear()
+        {
+            Reads.fill(0);
+            Writes.fill(0);
+            Executes.fill(0);
+        }
+
+        void Read(uint16_t address, size_t size) { add(Reads, address, size); }
+        void Write(uint16_t address, size_t size) { add(Writes, address, size); }
+        // both bytes of the instruction at pc
+        void Execute(uint16_t pc) { add(Executes, pc, 2); }
+
+        // halves every counter, call periodically so that the map shows
+        // recent activity rather than everything since the start
+        void Decay()
+        {
+            for (size_t i = 0; i < HEATMAP_SIZE; ++i)
+            {
+                Reads[i] >>= 1;
+                Writes[i] >>= 1;
+                Executes[i] >>= 1;
+            }
+        }
+
+    private:
+        static void add(std::array<uint32_t, HEATMAP_SIZE> &counters, uint16_t address, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                counters[(address + i) % HEATMAP_SIZE]++;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef _CHIP8_TRANSPOSITION_TABLE_H_
+#define _CHIP8_TRANSPOSITION_TABLE_H_
+
+#include "Utils/Hash.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace SKChip8
+{
+    // fixed capacity open-addressing map from state hashes to 64-bit values
+    // (e.g. search node indices). any number of threads may probe and insert
+    // concurrently without taking a lock. it is not strictly lock-free: a
+    // thread that finds a slot whose key is claimed but whose value is not yet
+    // published spins until the inserting thread finishes, so a stalled
+    // inserter can hold up readers of that one slot. entries are never removed
+    // except by Clear()
+    class TranspositionTable
+    {
+    public:
+        // reserved, cannot be stored
+        static constexpr uint64_t EMPTY_VALUE = ~0ull;
+
+        // the table holds 2^capacityLog2 entries
+        explicit TranspositionTable(uint8_t capacityLog2);
+
+        // returns the value stored for hash, or inserts value if there is none.
+        // the flag is true if this call inserted the entry
+        std::pair<uint64_t, bool> FindOrInsert(const Hash128 &hash, uint64_t value);
+
+        // returns true and sets value if hash is in the table
+        bool Probe(const Hash128 &hash, uint64_t &value) const;
+
+        size_t Size() const { return size_.load(std::memory_order_relaxed); }
+        size_t Capacity() const { return mask_ + 1; }
+
+        // not safe to call while other threads are using the table
+        void Clear();
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> check;
+            std::atomic<uint64_t> value;
+        };
+
+        // zero marks an empty slot so it is never used as a key
+        static uint64_t slotKey(const Hash128 &hash) { return hash.Low != 0 ? hash.Low : 1; }
+
+        // waits for a concurrent insert into slot to finish publishing its value
+        static uint64_t waitForValue(const Slot &slot);
+
+        std::unique_ptr<Slot[]> slots_;
+        size_t mask_;
+        std::atomic<size_t> size_;
+    };
+}
+
+#endif
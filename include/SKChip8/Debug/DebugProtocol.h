@@ -0,0 +1,79 @@
+#ifndef _CHIP8_DEBUG_PROTOCOL_H_
+#define _CHIP8_DEBUG_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // wire format of the debug server, all integers little endian. a request
+    // is
+    //   u8  command
+    //   u32 payload size
+    //   ... payload
+    // and every request gets exactly one response, in request order
+    //   u8  command (echoed)
+    //   u8  status
+    //   u32 payload size
+    //   ... payload, the error message if status is Error
+    // a client may send any number of requests before reading responses, the
+    // server answers them in one batch per read
+    static constexpr size_t DEBUG_REQUEST_HEADER_SIZE = 1 + 4;
+    static constexpr size_t DEBUG_RESPONSE_HEADER_SIZE = 1 + 1 + 4;
+    // larger payloads close the connection
+    static constexpr uint32_t DEBUG_MAX_PAYLOAD = 1 << 16;
+
+    static constexpr uint8_t DEBUG_PROTOCOL_MAGIC[4] = {'C', '8', 'D', 'B'};
+    static constexpr uint16_t DEBUG_PROTOCOL_VERSION = 1;
+
+    // payloads by command, request -> response
+    enum class DebugCommand : uint8_t
+    {
+        Hello = 1,        // -> magic, u16 version
+        LoadROM,          // path on the server's file system -> (empty), resets
+        Reset,            // -> (empty)
+        Run,              // u64 count -> u64 executed, u8 stopped at a breakpoint
+        Step,             // u64 count, ignores breakpoints -> (empty)
+        AddBreakpoint,    // u16 address, optional condition text -> (empty)
+        RemoveBreakpoint, // u16 address -> (empty)
+        AddWatchpoint,    // u16 address, u16 size, u8 read, u8 write -> (empty)
+        ClearBreakpoints, // removes breakpoints and watchpoints -> (empty)
+        ReadMemory,       // u16 address, u16 size -> bytes
+        ReadRegisters,    // -> u16 PC, u16 I, V0-VF, u8 DT, u8 ST, u64 cycle count
+        ReadFrame,        // -> packed framebuffer, one bit per pixel
+        SaveState,        // -> save state
+        LoadState,        // save state -> (empty)
+        SetKeys           // u16 key mask -> (empty)
+    };
+
+    enum class DebugStatus : uint8_t
+    {
+        Ok = 0,
+        Error = 1
+    };
+
+    static constexpr size_t DEBUG_REGISTERS_SIZE = 2 + 2 + 16 + 1 + 1 + 8;
+
+    void AppendDebugRequest(std::vector<uint8_t> &out, DebugCommand command, const uint8_t *payload, size_t size);
+    void AppendDebugResponse(std::vector<uint8_t> &out, DebugCommand command, DebugStatus status, const uint8_t *payload, size_t size);
+
+    // a request or response located in a receive buffer
+    struct DebugMessage
+    {
+        DebugCommand Command;
+        DebugStatus Status;
+        const uint8_t *Payload;
+        uint32_t PayloadSize;
+        // bytes of the buffer the message occupies
+        size_t Size;
+    };
+
+    // parse the message at the start of data. return false if it isn't all
+    // there yet, throw std::runtime_error if it exceeds DEBUG_MAX_PAYLOAD
+    bool ParseDebugRequest(const uint8_t *data, size_t size, DebugMessage &out);
+    bool ParseDebugResponse(const uint8_t *data, size_t size, DebugMessage &out);
+}
+
+#endif
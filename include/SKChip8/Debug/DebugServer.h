@@ -0,0 +1,96 @@
+#ifndef _CHIP8_DEBUG_SERVER_H_
+#define _CHIP8_DEBUG_SERVER_H_
+
+#include "DebugProtocol.h"
+#include "DebugTarget.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // serves DebugProtocol requests for an emulator over a Unix domain socket
+    // (POSIX only). single threaded: the emulator is only touched from Pump,
+    // so a front end can host the server in its own loop. each read is
+    // parsed for every complete request, and the responses go back in one
+    // write
+    class DebugServer
+    {
+    public:
+        // listens at unixPath, replacing any stale socket file. target must
+        // outlive the server
+        DebugServer(const std::string &unixPath, DebugTarget &target);
+        ~DebugServer();
+
+        DebugServer(const DebugServer &) = delete;
+        DebugServer &operator=(const DebugServer &) = delete;
+
+        // waits up to timeoutMs (-1 forever, 0 not at all) for activity, then
+        // accepts clients, executes every complete request and writes what
+        // the sockets will take
+        void Pump(int timeoutMs = 0);
+
+        size_t GetClientCount() const { return clients_.size(); }
+
+    private:
+        struct Client
+        {
+            int Fd;
+            std::vector<uint8_t> Input;
+            std::vector<uint8_t> Output;
+            // bytes of Output already sent
+            size_t Offset;
+        };
+
+        void acceptClients();
+        // returns false if the client should be dropped
+        bool receive(Client &client);
+        bool flush(Client &client);
+        // throws to answer with an error
+        void execute(DebugCommand command, const uint8_t *payload, size_t size, std::vector<uint8_t> &response);
+
+        int listenFd_;
+        std::string unixPath_;
+        DebugTarget &target_;
+        std::vector<Client> clients_;
+    };
+
+    // blocking client side of DebugServer. requests are queued with Send and
+    // go out together on Flush, so a script pays one round trip per batch
+    class DebugClient
+    {
+    public:
+        explicit DebugClient(const std::string &unixPath);
+        ~DebugClient();
+
+        DebugClient(const DebugClient &) = delete;
+        DebugClient &operator=(const DebugClient &) = delete;
+
+        struct Response
+        {
+            DebugCommand Command;
+            DebugStatus Status;
+            std::vector<uint8_t> Payload;
+
+            bool Ok() const { return Status == DebugStatus::Ok; }
+            // the server's message for a failed request
+            std::string Error() const { return std::string(Payload.begin(), Payload.end()); }
+        };
+
+        void Send(DebugCommand command, const std::vector<uint8_t> &payload = {});
+        // sends every queued request and waits for their responses, in order.
+        // throws std::runtime_error if the server goes away
+        std::vector<Response> Flush();
+
+        size_t GetPendingCount() const { return pending_; }
+
+    private:
+        int fd_;
+        std::vector<uint8_t> output_;
+        std::vector<uint8_t> input_;
+        size_t pending_;
+    };
+}
+
+#endif
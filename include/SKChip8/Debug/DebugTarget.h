@@ -0,0 +1,66 @@
+#ifndef _CHIP8_DEBUG_TARGET_H_
+#define _CHIP8_DEBUG_TARGET_H_
+
+#include <Emulator/Breakpoints.h>
+#include <Emulator/Emulator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SKChip8
+{
+    // the machine a DebugServer drives. every request that changes the
+    // machine goes through here, so that a front end keeping history of its
+    // own (an undo journal, rewind buffer or recording) can keep it in step.
+    // reads go straight to GetEmulator()
+    class DebugTarget
+    {
+    public:
+        virtual ~DebugTarget() = default;
+
+        virtual Emulator &GetEmulator() = 0;
+        virtual BreakpointSet &GetBreakpoints() = 0;
+
+        // loads the ROM at path and resets
+        virtual void LoadProgram(const std::string &path) = 0;
+        virtual void Reset() = 0;
+        // runs up to count instructions, stopping before a breakpoint other
+        // than one at the current PC. returns the number executed. both this
+        // and Step may throw std::invalid_argument for a count they won't run
+        virtual uint64_t Run(uint64_t count) = 0;
+        // runs count instructions, ignoring breakpoints
+        virtual void Step(uint64_t count) = 0;
+        // throws, leaving the machine unchanged, if data isn't a valid state
+        virtual void LoadState(const uint8_t *data, size_t size) = 0;
+        virtual void SetKeyMask(uint16_t mask) = 0;
+    };
+
+    // a bare emulator with nothing else to keep in step, e.g. a headless server
+    class EmulatorDebugTarget : public DebugTarget
+    {
+    public:
+        EmulatorDebugTarget(Emulator &emulator, BreakpointSet &breakpoints)
+            : emulator_(emulator), breakpoints_(breakpoints) {}
+
+        Emulator &GetEmulator() override { return emulator_; }
+        BreakpointSet &GetBreakpoints() override { return breakpoints_; }
+
+        void LoadProgram(const std::string &path) override
+        {
+            emulator_.LoadProgram(path);
+            emulator_.Reset();
+        }
+        void Reset() override { emulator_.Reset(); }
+        uint64_t Run(uint64_t count) override { return emulator_.RunUntilBreak(count, breakpoints_); }
+        void Step(uint64_t count) override { emulator_.Run(count); }
+        void LoadState(const uint8_t *data, size_t size) override { emulator_.LoadState(data, size); }
+        void SetKeyMask(uint16_t mask) override { emulator_.SetKeyMask(mask); }
+
+    private:
+        Emulator &emulator_;
+        BreakpointSet &breakpoints_;
+    };
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef _CHIP8_BREAKPOINTS_H_
+#define _CHIP8_BREAKPOINTS_H_
+
+#include <Core/CPU.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // a predicate on the machine state such as "V3 == 10" or "DT != 0",
+    // parsed once into operand/comparison/value so that checking it is a
+    // couple of switches
+    struct BreakCondition
+    {
+        enum class Operand : uint8_t
+        {
+            Register,
+            Index,
+            DelayTimer,
+            SoundTimer
+        };
+
+        enum class Comparison : uint8_t
+        {
+            Equal,
+            NotEqual,
+            Less,
+            LessEqual,
+            Greater,
+            GreaterEqual
+        };
+
+        Operand Left;
+        // V register for Operand::Register
+        uint8_t Register;
+        Comparison Compare;
+        uint16_t Value;
+
+        bool Evaluate(const CPU &cpu) const;
+
+        // "<operand> <comparison> <value>" with operand one of V0-VF, I, DT or
+        // ST and value in hex, e.g. "VA >= 3F" or "I == 0x300". throws
+        // std::invalid_argument on anything else
+        static BreakCondition Parse(const std::string &text);
+        std::string ToString() const;
+    };
+
+    struct Breakpoint
+    {
+        uint16_t Address;
+        bool Conditional;
+        BreakCondition Condition;
+    };
+
+    // stops when an instruction reads (fetch, sprite, FX65) or writes
+    // (FX33, FX55) any byte of [Address, Address + Size)
+    struct Watchpoint
+    {
+        uint16_t Address;
+        uint16_t Size;
+        bool Read;
+        bool Write;
+    };
+
+    // PC breakpoints, optionally conditional, and memory watchpoints. a
+    // bitmap of the addresses that have any breakpoint keeps the check for
+    // every other address to a single bit test. watchpoints are checked by
+    // asking the CPU what the next instruction will touch, so they cost
+    // nothing until one is set
+    class BreakpointSet
+    {
+    public:
+        BreakpointSet()
+        {
+            bits_.fill(0);
+            watchBits_.fill(0);
+        }
+
+        void Add(uint16_t address);
+        void Add(uint16_t address, const BreakCondition &condition);
+        // removes every breakpoint at address
+        void Remove(uint16_t address);
+        // removes the index-th entry of GetBreakpoints()
+        void RemoveAt(size_t index);
+        // throws std::invalid_argument for an empty range, one past the end
+        // of memory, or one that watches neither reads nor writes
+        void AddWatch(uint16_t address, uint16_t size, bool read, bool write);
+        // removes the index-th entry of GetWatchpoints()
+        void RemoveWatchAt(size_t index);
+
+        // removes every breakpoint and watchpoint
+        void Clear();
+
+        bool Empty() const { return breakpoints_.empty() && watchpoints_.empty(); }
+        bool IsSet(uint16_t address) const { return (bits_[(address % CHIP8_MEM_SIZE) / 64] >> (address % 64)) & 1; }
+
+        // true if execution should stop before the instruction at the PC
+        bool ShouldBreak(const CPU &cpu) const
+        {
+            return (IsSet(cpu.GetPC()) && checkConditions(cpu)) ||
+                   (!watchpoints_.empty() && FindWatchHit(cpu) != nullptr);
+        }
+
+        // calls step() until count instructions have run or the next one
+        // would break, and returns how many ran. the instruction at the
+        // current PC always runs so that running again from a breakpoint
+        // moves past it
+        template <typename StepFunction>
+        uint64_t RunUntilBreak(const CPU &cpu, uint64_t count, StepFunction step) const
+        {
+            for (uint64_t executed = 0; executed < count; ++executed)
+            {
+                if (executed > 0 && ShouldBreak(cpu))
+                {
+                    return executed;
+                }
+                step();
+            }
+            return count;
+        }
+
+        // the watchpoint the next instruction would trigger, or nullptr.
+        // access, if given, receives the access that triggers it
+        const Watchpoint *FindWatchHit(const CPU &cpu, MemoryAccess *access = nullptr) const;
+
+        // in the order they were added
+        const std::vector<Breakpoint> &GetBreakpoints() const { return breakpoints_; }
+        const std::vector<Watchpoint> &GetWatchpoints() const { return watchpoints_; }
+
+    private:
+        bool checkConditions(const CPU &cpu) const;
+        void rebuildWatchBits();
+
+        static constexpr uint8_t WATCH_READ = 1 << 0;
+        static constexpr uint8_t WATCH_WRITE = 1 << 1;
+
+        std::array<uint64_t, CHIP8_MEM_SIZE / 64> bits_;
+        std::vector<Breakpoint> breakpoints_;
+        // WATCH_* flags per address
+        std::array<uint8_t, CHIP8_MEM_SIZE> watchBits_;
+        std::vector<Watchpoint> watchpoints_;
+    };
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _CHIP8_DISASSEMBLY_H_
+#define _CHIP8_DISASSEMBLY_H_
+
+#include <Core/CPU.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace SKChip8
+{
+    // disassembly of every address in memory, kept in step with a copy of
+    // the bytes it was made from. instructions can sit at odd addresses, so
+    // there is a line per byte and a changed byte redoes the two lines that
+    // cover it. text is formatted once into fixed buffers, reading a line
+    // never allocates
+    class DisassemblyCache
+    {
+    public:
+        static constexpr size_t TEXT_SIZE = 32;
+
+        struct Line
+        {
+            uint16_t Opcode;
+            // false for words that do not decode, shown as DW
+            bool Valid;
+            char Text[TEXT_SIZE];
+        };
+
+        DisassemblyCache();
+
+        // redoes the lines whose bytes differ from the last update, all of
+        // them the first time. returns how many lines were formatted
+        size_t Update(const std::array<uint8_t, CHIP8_MEM_SIZE> &memory);
+        // the next update formats everything again
+        void Invalidate() { valid_ = false; }
+
+        const Line &At(uint16_t address) const { return lines_[address % CHIP8_MEM_SIZE]; }
+
+    private:
+        void formatLine(uint16_t address);
+
+        std::array<uint8_t, CHIP8_MEM_SIZE> memory_;
+        std::array<Line, CHIP8_MEM_SIZE> lines_;
+        bool valid_;
+    };
+}
+
+#endif
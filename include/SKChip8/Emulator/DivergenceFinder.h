@@ -0,0 +1,60 @@
+#ifndef _DIVERGENCE_FINDER_H
+#define _DIVERGENCE_FINDER_H
+
+#include "Emulator.h"
+#include "Movie.h"
+
+#include <cstdint>
+#include <string>
+
+namespace SKChip8
+{
+    // an execution path under comparison
+    struct ExecutionEngine
+    {
+        std::string Name;
+        RunFunction Run;
+    };
+
+    // the reference: one Emulator::Step (and so one CPU::Cycle) at a time
+    ExecutionEngine ReferenceEngine();
+    // Emulator::Run, which batches instructions between timer ticks
+    ExecutionEngine BatchedEngine();
+
+    struct DivergenceReport
+    {
+        bool Diverged;
+        // instructions both engines executed identically. when Diverged the
+        // instruction at this cycle is the first one they disagree on
+        uint64_t MatchingCycles;
+        // the common state before that instruction and each engine's state after it
+        Emulator::SaveStateBuffer Before;
+        Emulator::SaveStateBuffer AfterA;
+        Emulator::SaveStateBuffer AfterB;
+    };
+
+    // plays a movie on two engines in lockstep, comparing state hashes every
+    // checkInterval instructions. on a mismatch it goes back to the last
+    // matching snapshot and bisects down to the first differing instruction,
+    // so nothing but two snapshots is kept no matter how long the run is
+    class DivergenceFinder
+    {
+    public:
+        DivergenceFinder(ExecutionEngine a, ExecutionEngine b, uint64_t checkInterval = 4096);
+
+        // a and b need the movie's ROM loaded, both are reset before playback
+        DivergenceReport Run(const Movie &movie, Emulator &a, Emulator &b);
+
+        const ExecutionEngine &GetEngineA() const { return engineA_; }
+        const ExecutionEngine &GetEngineB() const { return engineB_; }
+
+    private:
+        static bool matches(const Emulator &a, const Emulator &b);
+
+        ExecutionEngine engineA_;
+        ExecutionEngine engineB_;
+        uint64_t checkInterval_;
+    };
+}
+
+#endif
@@ -3,7 +3,10 @@
 
 #include <Core/CPU.h>
 #include <Utils/ROMLoader.h>
+#include "Breakpoints.h"
+#include "UndoJournal.h"
 #include <chrono>
+#include <memory>
 #include <string>
 
 using namespace std::chrono_literals;
@@ -17,13 +20,19 @@ namespace SKChip8
     // as the clock speed which (on the COSMAC VIP) is 1.76MHz
     static constexpr auto EMULATOR_CPU_HZ = 550;
 
+    // binary save state layout: "C8ST" magic, u16 version, u16 reserved,
+    // the CPU state, then the emulator's u64 tick counters
+    static constexpr uint8_t SAVE_STATE_MAGIC[4] = {'C', '8', 'S', 'T'};
+    static constexpr uint16_t SAVE_STATE_VERSION = 1;
+    static constexpr size_t SAVE_STATE_HEADER_SIZE = 8;
+    static constexpr size_t SAVE_STATE_SIZE = SAVE_STATE_HEADER_SIZE + CPU::STATE_SIZE + 2 * 8;
+
     class Emulator
     {
 
     public:
         Emulator()
         {
-            chip8CPU_ = std::make_shared<CPU>();
             instructionsSinceLastTick_ = 0;
             instructionsPerTick_ = EMULATOR_CPU_HZ / SKChip8::TIMER_HZ;
         }
@@ -31,20 +40,70 @@ namespace SKChip8
         void LoadProgram(const std::string &rompath);
         void Reset();
         void Step();
+        // executes count instructions, equivalent to calling Step() count times
+        void Run(uint64_t count);
+        // Run() that stops before an instruction breakpoints break on and
+        // returns how many instructions ran. the instruction at the current PC
+        // always runs so that running again from a breakpoint moves past it.
+        // with no breakpoints set this is Run()
+        uint64_t RunUntilBreak(uint64_t count, const BreakpointSet &breakpoints);
         void SetKeyState(uint8_t key, bool state);
 
-        CPU::FrameBuffer GetFrameBuffer() const { return chip8CPU_->GetFrameBuffer(); }
-        std::shared_ptr<const CPU> GetCPU() const { return chip8CPU_; }
+        // Step() that first records how to undo it in journal. any other change
+        // to the machine (Run, Reset, LoadState...) leaves the journal stale, so
+        // clear it when doing those
+        void StepJournaled(UndoJournal &journal);
+        // undoes the newest journaled step. returns false if there is none
+        bool StepBack(UndoJournal &journal);
+
+        // seeds the CPU's random number generator. Reset() reseeds from the
+        // wall clock, so call this after Reset() for reproducible runs
+        void SeedRandom(uint32_t seed);
+
+        // key state as a bitmask, bit n is key n
+        void SetKeyMask(uint16_t mask);
+        uint16_t GetKeyMask() const;
+
+        // copies the whole machine (CPU, timer phase and RNG). the ROM is shared
+        // rather than reloaded so the only allocation is the new instance itself
+        std::unique_ptr<Emulator> Clone() const;
+
+        // overwrites target with this machine's state without allocating
+        void CloneInto(Emulator &target) const;
+
+        using SaveStateBuffer = std::array<uint8_t, SAVE_STATE_SIZE>;
+
+        // fixed size binary snapshot of the CPU and timer phase. the ROM is not
+        // included, LoadState keeps whatever program is currently loaded
+        void SaveState(SaveStateBuffer &out) const;
+        SaveStateBuffer SaveState() const;
+
+        // throws if data isn't a save state of the current version
+        void LoadState(const uint8_t *data, size_t size);
+        void LoadState(const SaveStateBuffer &state) { LoadState(state.data(), state.size()); }
+
+        // CPU state hash combined with the timer phase. not thread-safe,
+        // see CPU::StateHash
+        Hash128 StateHash() const;
+
+        // hash of the loaded ROM image, zero if none is loaded
+        Hash128 GetROMHash() const;
+
+        // instructions executed since the last Reset()
+        uint64_t GetCycleCount() const { return chip8CPU_.GetCycleCount(); }
+
+        CPU::FrameBuffer GetFrameBuffer() const { return chip8CPU_.GetFrameBuffer(); }
+        const CPU &GetCPU() const { return chip8CPU_; }
 
         uint64_t GetIPT() const { return instructionsPerTick_; }
 
     protected:
-        std::shared_ptr<CPU> chip8CPU_;
+        CPU chip8CPU_;
 
     private:
         void reloadROM();
 
-        ROMLoader ROM_;
+        std::shared_ptr<const ROMLoader> ROM_;
         uint64_t instructionsPerTick_;
         uint64_t instructionsSinceLastTick_;
     };
@@ -0,0 +1,33 @@
+#ifndef _EMULATOR_POOL_H
+#define _EMULATOR_POOL_H
+
+#include "Emulator.h"
+
+#include <memory>
+#include <vector>
+
+namespace SKChip8
+{
+    // recycles Emulator instances so that forking a machine (e.g. at every node
+    // of a tree search) does not hit the allocator once the pool is warm.
+    // not thread safe, use one pool per search thread
+    class EmulatorPool
+    {
+    public:
+        // returns a copy of source, reusing a released instance if one is available
+        std::unique_ptr<Emulator> Acquire(const Emulator &source);
+
+        // hands an instance back to the pool for reuse
+        void Release(std::unique_ptr<Emulator> emulator);
+
+        // allocates instances up front until count are available
+        void Reserve(size_t count);
+
+        size_t Available() const { return free_.size(); }
+
+    private:
+        std::vector<std::unique_ptr<Emulator>> free_;
+    };
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef _MOVIE_H
+#define _MOVIE_H
+
+#include "Emulator.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SKChip8
+{
+    // a recorded input sequence. playback starts from a freshly reset machine
+    // seeded with Seed, and the key mask changes to KeyMask right before the
+    // instruction at Cycle executes. since input is stored per change rather
+    // than per frame, replay is exact no matter how the recording front end
+    // batched its instructions
+    struct MovieEvent
+    {
+        uint64_t Cycle;
+        uint16_t KeyMask;
+    };
+
+    struct Movie
+    {
+        Hash128 ROMHash;
+        uint32_t Seed;
+        // total cycles recorded
+        uint64_t Length;
+        // state at the end of the recording, used to verify playback
+        Hash128 FinalStateHash;
+        uint64_t FinalFrameHash;
+        std::vector<MovieEvent> Events;
+
+        // binary format: "C8MV" magic, u16 version, u16 reserved, the fields
+        // above in order (little endian), then u32 event count and events
+        void Save(const std::string &path) const;
+        static Movie Load(const std::string &path);
+    };
+
+    // hash of the visible screen only
+    uint64_t FrameHash(const Emulator &emulator);
+
+    class MovieRecorder
+    {
+    public:
+        MovieRecorder() : recording_(false) {}
+
+        // resets and seeds the emulator and starts a new recording
+        void Begin(Emulator &emulator, uint32_t seed);
+
+        // records the emulator's key state if it changed. call whenever input
+        // may have changed, before running more instructions. if the emulator
+        // was rewound, input recorded after its current cycle is dropped
+        void Observe(const Emulator &emulator);
+
+        // stops recording and returns the movie, ending at the current cycle
+        Movie Finish(const Emulator &emulator);
+
+        bool IsRecording() const { return recording_; }
+
+    private:
+        Movie movie_;
+        uint16_t lastMask_;
+        bool recording_;
+    };
+
+    // advances an emulator by a number of instructions. Emulator::Run by
+    // default, replaceable to drive playback through another execution path
+    using RunFunction = std::function<void(Emulator &, uint64_t)>;
+
+    class MoviePlayer
+    {
+    public:
+        explicit MoviePlayer(Movie movie) : movie_(std::move(movie)), nextEvent_(0) {}
+
+        // resets and seeds the emulator for playback. throws if the loaded ROM
+        // isn't the one the movie was recorded with
+        void Begin(Emulator &emulator);
+
+        // runs until the emulator has executed cycle instructions since Begin,
+        // applying recorded input along the way. returns false at the end of
+        // the movie
+        bool RunTo(Emulator &emulator, uint64_t cycle);
+        bool RunTo(Emulator &emulator, uint64_t cycle, const RunFunction &run);
+        void RunToEnd(Emulator &emulator) { RunTo(emulator, movie_.Length); }
+
+        // continues playback from the emulator's current cycle, e.g. after
+        // loading a state saved earlier in this movie. input recorded at or
+        // before that cycle is assumed to be in the state already
+        void Resync(const Emulator &emulator);
+
+        // true if emulator matches the state the recording ended in
+        bool Verify(const Emulator &emulator) const;
+
+        const Movie &GetMovie() const { return movie_; }
+
+    private:
+        Movie movie_;
+        size_t nextEvent_;
+    };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _MOVIE_INDEX_H
+#define _MOVIE_INDEX_H
+
+#include "Emulator.h"
+#include "Movie.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // save states of a movie's playback taken every Interval cycles. seeking
+    // loads the nearest keyframe at or before the target and replays only the
+    // rest, so any position is at most Interval instructions away. the index
+    // is kept in a side file next to the movie and rebuilt when it no longer
+    // matches the movie
+    class MovieIndex
+    {
+    public:
+        static constexpr uint64_t DEFAULT_INTERVAL = 100000;
+
+        // plays the whole movie on emulator, which needs the movie's ROM loaded
+        static MovieIndex Build(const Movie &movie, Emulator &emulator, uint64_t interval = DEFAULT_INTERVAL);
+
+        // binary format: "C8KI" magic, u16 version, u16 reserved, the movie's
+        // ROM hash, seed, length and final state hash, u64 interval, u32
+        // keyframe count, then per keyframe u64 cycle, u32 size and the
+        // run-length encoded save state
+        void Save(const std::string &path) const;
+        // throws if the file is unreadable or was built for a different movie
+        static MovieIndex Load(const std::string &path, const Movie &movie);
+
+        // the side file of the movie at moviePath
+        static std::string PathFor(const std::string &moviePath);
+        // loads the side file, or builds the index and writes it if the file
+        // is missing or stale
+        static MovieIndex Open(const std::string &moviePath, const Movie &movie, Emulator &emulator,
+                               uint64_t interval = DEFAULT_INTERVAL);
+
+        // moves playback to cycle (clamped to the movie length). player must be
+        // for the indexed movie and Begin()'d on emulator
+        void Seek(MoviePlayer &player, Emulator &emulator, uint64_t cycle) const;
+
+        uint64_t GetInterval() const { return interval_; }
+        size_t GetKeyframeCount() const { return keyframes_.size(); }
+        size_t GetEncodedBytes() const;
+
+    private:
+        struct Keyframe
+        {
+            uint64_t Cycle;
+            std::vector<uint8_t> State;
+        };
+
+        MovieIndex() : interval_(DEFAULT_INTERVAL) {}
+        bool matches(const Movie &movie) const;
+
+        Hash128 ROMHash_;
+        uint32_t seed_;
+        uint64_t length_;
+        Hash128 finalStateHash_;
+        uint64_t interval_;
+        std::vector<Keyframe> keyframes_;
+    };
+}
+
+#endif
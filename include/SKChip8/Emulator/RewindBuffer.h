@@ -0,0 +1,67 @@
+#ifndef _REWIND_BUFFER_H
+#define _REWIND_BUFFER_H
+
+#include "Emulator.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace SKChip8
+{
+    // fixed size history of save states, one per captured frame. every
+    // keyframeInterval frames a full (run-length encoded) state is stored,
+    // otherwise the XOR delta against the previous frame, which is usually a
+    // few dozen bytes. when the buffer is full the oldest frames are dropped.
+    // seeking decodes one keyframe plus at most keyframeInterval - 1 deltas
+    class RewindBuffer
+    {
+    public:
+        explicit RewindBuffer(size_t capacityBytes = 4 << 20, uint32_t keyframeInterval = 60);
+
+        // appends the emulator's current state as the newest frame
+        void Capture(const Emulator &emulator);
+
+        // loads the state from framesBack frames before the newest one (0 is
+        // the newest) into emulator. returns false if it isn't in the buffer
+        bool Seek(size_t framesBack, Emulator &emulator) const;
+
+        // forgets the framesBack newest frames so that capturing continues
+        // from an earlier point, e.g. when resuming after a rewind
+        void Truncate(size_t framesBack);
+
+        void Clear();
+
+        size_t GetFrameCount() const { return records_.size(); }
+        size_t GetUsedBytes() const;
+        size_t GetCapacity() const { return data_.size(); }
+
+    private:
+        struct Record
+        {
+            size_t Offset;
+            size_t Size;
+            bool Keyframe;
+        };
+
+        // makes room for size bytes at head_, dropping the oldest records
+        void reserve(size_t size);
+        void evict(size_t begin, size_t end);
+        // rebuilds the state of records_[index]
+        void decode(size_t index, Emulator::SaveStateBuffer &state) const;
+
+        std::vector<uint8_t> data_;
+        std::deque<Record> records_;
+        size_t head_;
+
+        uint32_t keyframeInterval_;
+        uint32_t framesSinceKeyframe_;
+
+        // the newest captured state, base for the next delta
+        Emulator::SaveStateBuffer previous_;
+        Emulator::SaveStateBuffer current_;
+        std::vector<uint8_t> scratch_;
+    };
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef _CHIP8_STATE_SNAPSHOT_H_
+#define _CHIP8_STATE_SNAPSHOT_H_
+
+#include <Core/CPU.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace SKChip8
+{
+    class Emulator;
+
+    // what a debugger shows of the machine, captured at one instant
+    struct StateSnapshot
+    {
+        // increases with every published snapshot, 0 until the first
+        uint64_t Generation;
+        uint64_t CycleCount;
+
+        uint16_t PC;
+        uint16_t CurrentInstruction;
+        uint16_t IndexPointer;
+        std::array<uint8_t, REG_COUNT> Registers;
+        uint8_t DelayTimer;
+        uint8_t SoundTimer;
+        std::array<bool, KEY_COUNT> KeyState;
+        std::array<uint8_t, CHIP8_MEM_SIZE> Memory;
+        CPU::PackedFrameBuffer FrameBuffer;
+    };
+
+    // double buffered snapshots of an emulator for readers on any thread.
+    // the emulating thread publishes into the buffer readers are not using
+    // and flips, readers pin the current buffer and read it in place. a
+    // snapshot never changes while pinned, so everything a reader sees comes
+    // from the same instant
+    class SnapshotPublisher
+    {
+    public:
+        // keeps its snapshot pinned until destroyed. hold it for a frame at
+        // most, publishing skips while the only free buffer is pinned
+        class View
+        {
+        public:
+            View(View &&other) noexcept : snapshot_(other.snapshot_), pins_(other.pins_) { other.pins_ = nullptr; }
+            ~View()
+            {
+                if (pins_)
+                {
+                    pins_->fetch_sub(1);
+                }
+            }
+
+            View(const View &) = delete;
+            View &operator=(const View &) = delete;
+            View &operator=(View &&) = delete;
+
+            const StateSnapshot &operator*() const { return *snapshot_; }
+            const StateSnapshot *operator->() const { return snapshot_; }
+
+        private:
+            friend class SnapshotPublisher;
+            View(const StateSnapshot *snapshot, std::atomic<int> *pins) : snapshot_(snapshot), pins_(pins) {}
+
+            const StateSnapshot *snapshot_;
+            std::atomic<int> *pins_;
+        };
+
+        SnapshotPublisher();
+
+        // captures emulator into the back buffer and makes it current. only
+        // one thread may publish. returns false, publishing nothing, if a
+        // reader still has the back buffer pinned
+        bool Publish(const Emulator &emulator);
+
+        // the newest snapshot, safe from any thread and never blocks
+        View Acquire() const;
+
+    private:
+        std::array<StateSnapshot, 2> buffers_;
+        std::atomic<int> front_;
+        mutable std::array<std::atomic<int>, 2> pins_;
+        uint64_t generation_;
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _UNDO_JOURNAL_H
+#define _UNDO_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace SKChip8
+{
+    // fixed size ring of undo records, one per journaled instruction. a record
+    // only holds what its instruction overwrites (usually ~60 bytes), so a few
+    // megabytes reach back hundreds of thousands of instructions. when the ring
+    // is full the oldest records are dropped
+    class UndoJournal
+    {
+    public:
+        explicit UndoJournal(size_t capacityBytes = 4 << 20);
+
+        // returns an empty buffer to fill with the next record
+        std::vector<uint8_t> &BeginRecord();
+        // appends the buffer returned by BeginRecord as the newest record
+        void CommitRecord();
+
+        // removes the newest record and returns its contents, valid until the
+        // next call. returns nullptr if the journal is empty
+        const std::vector<uint8_t> *PopRecord();
+
+        void Clear();
+
+        size_t GetRecordCount() const { return records_.size(); }
+        size_t GetCapacity() const { return data_.size(); }
+
+    private:
+        struct Record
+        {
+            size_t Offset;
+            size_t Size;
+        };
+
+        std::vector<uint8_t> data_;
+        std::deque<Record> records_;
+        size_t head_;
+        std::vector<uint8_t> scratch_;
+    };
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef _CHIP8_SESSION_HOST_H_
+#define _CHIP8_SESSION_HOST_H_
+
+#include "TimerWheel.h"
+
+#include <Emulator/Emulator.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SKChip8
+{
+    struct SessionStats
+    {
+        uint64_t Frames;
+        // how long after its deadline each frame started running
+        double MeanLatenessMs;
+        double MaxLatenessMs;
+    };
+
+    // runs many emulators in real time on a fixed pool of worker threads. a
+    // single scheduler thread keeps every session in a timer wheel keyed by its
+    // next frame deadline and hands due sessions to the workers, which run one
+    // frame worth of instructions per wakeup
+    class SessionHost
+    {
+    public:
+        using SessionId = uint32_t;
+
+        // frames per second for each session
+        static constexpr double FRAME_HZ = 60.0;
+        // resolution of the timer wheel
+        static constexpr auto TICK = 1ms;
+
+        explicit SessionHost(size_t threadCount);
+        ~SessionHost();
+
+        // sessions can only be added while the host is stopped
+        SessionId AddSession(std::unique_ptr<Emulator> emulator);
+
+        void Start();
+        void Stop();
+
+        // can be called from any thread, applied at the start of the next frame
+        void SetKeyMask(SessionId session, uint16_t mask);
+
+        SessionStats GetSessionStats(SessionId session) const;
+        size_t GetSessionCount() const { return sessions_.size(); }
+
+        // host CPU time consumed per wall clock second since Start(), i.e. 1.0
+        // is one core fully busy
+        double GetCPUUsage() const;
+
+    private:
+        struct Session
+        {
+            std::unique_ptr<Emulator> Machine;
+            EmulatorClock::time_point Deadline;
+            // fractional instructions carried over between frames
+            double InstructionCredit = 0.0;
+
+            std::atomic<uint16_t> KeyMask{0};
+            std::atomic<uint64_t> Frames{0};
+            std::atomic<uint64_t> TotalLatenessNs{0};
+            std::atomic<uint64_t> MaxLatenessNs{0};
+        };
+
+        void schedulerLoop();
+        void workerLoop();
+        void runFrame(Session &session);
+
+        // deadline -> the first tick at or after it
+        uint64_t toTick(EmulatorClock::time_point time) const;
+        // current time -> the last tick at or before it
+        uint64_t elapsedTicks(EmulatorClock::time_point time) const;
+
+        std::vector<std::unique_ptr<Session>> sessions_;
+        size_t threadCount_;
+
+        TimerWheel wheel_;
+        std::mutex wheelMutex_;
+
+        std::deque<SessionId> ready_;
+        std::mutex readyMutex_;
+        std::condition_variable readyCondition_;
+
+        std::thread scheduler_;
+        std::vector<std::thread> workers_;
+        std::atomic<bool> running_;
+
+        EmulatorClock::time_point epoch_;
+        std::clock_t startCPUTime_;
+    };
+}
+
+#endif
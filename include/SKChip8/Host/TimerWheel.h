@@ -0,0 +1,60 @@
+#ifndef _CHIP8_TIMER_WHEEL_H_
+#define _CHIP8_TIMER_WHEEL_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace SKChip8
+{
+    // two level hierarchical timer wheel with an overflow list. time is measured
+    // in abstract ticks (the session host uses 1ms). the inner wheel covers the
+    // next 256 ticks one slot per tick, the outer wheel the next 64 * 256 ticks.
+    // timers further out than that wait in the overflow list
+    class TimerWheel
+    {
+    public:
+        static constexpr size_t INNER_BITS = 8;
+        static constexpr size_t OUTER_BITS = 6;
+        static constexpr size_t INNER_SLOTS = 1 << INNER_BITS;
+        static constexpr size_t OUTER_SLOTS = 1 << OUTER_BITS;
+
+        using TimerId = uint32_t;
+        using Callback = std::function<void(TimerId)>;
+
+        explicit TimerWheel(uint64_t startTick = 0);
+
+        // fires id once the wheel reaches deadline (or on the next Advance if
+        // the deadline has already passed)
+        void Schedule(TimerId id, uint64_t deadline);
+
+        // processes every tick up to and including now, calling fire for each
+        // expired timer in deadline order
+        void Advance(uint64_t now, const Callback &fire);
+
+        uint64_t CurrentTick() const { return currentTick_; }
+        size_t Size() const { return size_; }
+
+    private:
+        struct Entry
+        {
+            TimerId Id;
+            uint64_t Deadline;
+        };
+
+        void place(const Entry &entry);
+        void cascade();
+
+        std::array<std::vector<Entry>, INNER_SLOTS> inner_;
+        std::array<std::vector<Entry>, OUTER_SLOTS> outer_;
+        std::vector<Entry> overflow_;
+        std::vector<Entry> scratch_;
+
+        // the next tick to be processed
+        uint64_t currentTick_;
+        size_t size_;
+    };
+}
+
+#endif
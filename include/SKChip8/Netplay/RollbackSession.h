@@ -0,0 +1,102 @@
+#ifndef _CHIP8_ROLLBACK_SESSION_H_
+#define _CHIP8_ROLLBACK_SESSION_H_
+
+#include <Emulator/Emulator.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace SKChip8
+{
+    // transport independent rollback netcode. every peer runs its own copy of
+    // the machine and the key state is the OR of every player's 16-bit mask.
+    // remote inputs that haven't arrived yet are predicted to repeat the last
+    // confirmed one. when a confirmed input contradicts a prediction the session
+    // restores the snapshot taken at the start of that frame and re-simulates
+    // up to the present
+    class RollbackSession
+    {
+    public:
+        static constexpr size_t MAX_PLAYERS = 4;
+        // how far the local simulation may run ahead of confirmed input
+        static constexpr uint32_t MAX_ROLLBACK_FRAMES = 16;
+        static constexpr double FRAME_HZ = 60.0;
+
+        // every peer must start from an identical machine (same ROM and seed)
+        RollbackSession(const Emulator &initial, uint8_t playerCount, uint8_t localPlayer);
+
+        // simulates the next frame with the given local input. returns false
+        // without advancing if the remote players are too far behind
+        bool AdvanceFrame(uint16_t localMask);
+
+        // records a confirmed input from a remote player. inputs must arrive in
+        // frame order, anything past the next expected frame is dropped
+        void AddRemoteInput(uint8_t player, uint32_t frame, uint16_t mask);
+
+        // re-simulates from the earliest mispredicted frame if needed. called by
+        // AdvanceFrame, but also useful to settle the state while stalled
+        void ApplyRollback();
+
+        // first frame whose inputs for player aren't known yet
+        uint32_t GetInputCount(uint8_t player) const { return static_cast<uint32_t>(inputs_[player].size()); }
+        uint16_t GetInput(uint8_t player, uint32_t frame) const { return inputs_[player][frame]; }
+
+        // number of frames simulated so far
+        uint32_t GetFrame() const { return frame_; }
+
+        // every frame before this one has confirmed input from all players
+        uint32_t GetConfirmedFrame() const;
+
+        // hash of the state at the start of a confirmed frame, if still in history
+        bool GetConfirmedHash(uint32_t frame, uint64_t &hash) const;
+        // the most recent confirmed frame that has a hash
+        uint32_t GetLastHashedFrame() const { return hashedFrames_; }
+
+        const Emulator &GetEmulator() const { return emulator_; }
+        uint8_t GetLocalPlayer() const { return localPlayer_; }
+
+        uint64_t GetRollbackCount() const { return rollbacks_; }
+        uint32_t GetMaxResimulatedFrames() const { return maxResimulated_; }
+
+        // instructions executed in a frame, spread so that 60 frames run
+        // exactly EMULATOR_CPU_HZ instructions
+        static uint64_t InstructionsForFrame(uint32_t frame);
+
+    private:
+        static constexpr size_t SNAPSHOT_COUNT = MAX_ROLLBACK_FRAMES + 1;
+        static constexpr size_t HASH_HISTORY = 256;
+
+        uint16_t inputFor(uint8_t player, uint32_t frame) const;
+        void simulateFrame(uint32_t frame);
+        void recordConfirmedHashes();
+
+        Emulator emulator_;
+        std::array<Emulator, SNAPSHOT_COUNT> snapshots_;
+
+        uint8_t playerCount_;
+        uint8_t localPlayer_;
+
+        // confirmed inputs per player, indexed by frame
+        std::array<std::vector<uint16_t>, MAX_PLAYERS> inputs_;
+        // the input each player was assumed to have when a frame was last simulated
+        std::array<std::array<uint16_t, SNAPSHOT_COUNT>, MAX_PLAYERS> usedInputs_;
+
+        uint32_t frame_;
+        // earliest frame that has to be re-simulated, frame_ if none
+        uint32_t rollbackFrame_;
+
+        struct HashEntry
+        {
+            uint32_t Frame;
+            uint64_t Hash;
+        };
+        std::array<HashEntry, HASH_HISTORY> hashes_;
+        uint32_t hashedFrames_;
+
+        uint64_t rollbacks_;
+        uint32_t maxResimulated_;
+    };
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _CHIP8_UDP_SOCKET_H_
+#define _CHIP8_UDP_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SKChip8
+{
+    // minimal non-blocking IPv4 UDP socket (POSIX only)
+    class UDPSocket
+    {
+    public:
+        struct Endpoint
+        {
+            uint32_t Address; // network byte order
+            uint16_t Port;    // host byte order
+        };
+
+        // binds to port on all interfaces
+        explicit UDPSocket(uint16_t port);
+        ~UDPSocket();
+
+        UDPSocket(const UDPSocket &) = delete;
+        UDPSocket &operator=(const UDPSocket &) = delete;
+
+        // parses "host:port", host must be a dotted IPv4 address
+        static Endpoint ParseEndpoint(const std::string &text);
+
+        void SendTo(const Endpoint &to, const void *data, size_t size);
+
+        // returns the number of bytes received or 0 if nothing is pending
+        size_t Receive(void *data, size_t capacity);
+
+    private:
+        int fd_;
+    };
+}
+
+#endif
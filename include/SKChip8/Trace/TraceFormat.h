@@ -0,0 +1,56 @@
+#ifndef _CHIP8_TRACE_FORMAT_H_
+#define _CHIP8_TRACE_FORMAT_H_
+
+#include <Core/CPU.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace SKChip8
+{
+    // one executed instruction
+    struct TraceRecord
+    {
+        // cycle count before the instruction ran
+        uint64_t Cycle;
+        uint16_t PC;
+        uint16_t Opcode;
+        // registers the instruction changed, bit n is Vn
+        uint16_t ChangedRegisters;
+        // the register file after the instruction
+        std::array<uint8_t, REG_COUNT> Registers;
+    };
+
+    // trace file layout:
+    //   "C8TR" magic, u16 version, u16 reserved
+    //   blocks, each a TRACE_BLOCK_HEADER_SIZE header followed by its records
+    //   index: per block u64 first cycle, u64 file offset, u32 record count
+    //   u64 index offset, u32 block count, "C8TI" magic
+    // all integers are little endian. the index is written on close; a trace
+    // without one (e.g. the process died) is still readable block by block
+    static constexpr uint8_t TRACE_MAGIC[4] = {'C', '8', 'T', 'R'};
+    static constexpr uint8_t TRACE_INDEX_MAGIC[4] = {'C', '8', 'T', 'I'};
+    static constexpr uint16_t TRACE_VERSION = 1;
+    static constexpr size_t TRACE_FILE_HEADER_SIZE = 8;
+    static constexpr size_t TRACE_INDEX_ENTRY_SIZE = 8 + 8 + 4;
+    static constexpr size_t TRACE_FOOTER_SIZE = 8 + 4 + 4;
+
+    // block header: u64 first cycle, u32 record count, u32 encoded size,
+    // then the register file after the first record
+    static constexpr size_t TRACE_BLOCK_HEADER_SIZE = 8 + 4 + 4 + REG_COUNT;
+
+    // records are stored relative to the one before them: varint cycle delta,
+    // zigzag varint PC delta, the opcode, the changed register mask and the new
+    // value of each changed register. that is 5 bytes for a record that
+    // changes no register (e.g. a cycle spent halted on FX0A) plus a byte per
+    // changed register, more for jumps of 64+ bytes or changes to V7-VF which
+    // widen the varints. 5-6 bytes on average for the bundled ROMs
+    void EncodeTraceBlock(const TraceRecord *records, size_t count, std::vector<uint8_t> &out);
+
+    // decodes a whole block (header included) starting at data. returns the
+    // number of bytes consumed, or 0 if the block is malformed or truncated
+    size_t DecodeTraceBlock(const uint8_t *data, size_t size, std::vector<TraceRecord> &out);
+}
+
+#endif
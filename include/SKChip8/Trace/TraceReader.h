@@ -0,0 +1,68 @@
+#ifndef _CHIP8_TRACE_READER_H_
+#define _CHIP8_TRACE_READER_H_
+
+#include "TraceFormat.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SKChip8
+{
+    // random access to a trace written by TraceWriter. the file is memory
+    // mapped (POSIX only) and only the block holding the requested cycle is
+    // decoded, so lookups cost the same for a trace of any length
+    class TraceReader
+    {
+    public:
+        // throws if the file can't be mapped or isn't a trace
+        explicit TraceReader(const std::string &path);
+        ~TraceReader();
+
+        TraceReader(const TraceReader &) = delete;
+        TraceReader &operator=(const TraceReader &) = delete;
+
+        uint64_t GetRecordCount() const { return recordCount_; }
+        size_t GetBlockCount() const { return blocks_.size(); }
+        // cycle of the first and last record, both 0 for an empty trace
+        uint64_t GetFirstCycle() const;
+        uint64_t GetLastCycle() const { return lastCycle_; }
+
+        // the record of the instruction that started at cycle. cycles spent
+        // halted are recorded like any other. returns false if cycle is
+        // outside the trace or in a gap where the machine ran untraced
+        bool Find(uint64_t cycle, TraceRecord &record) const;
+
+        // calls visit for every record with a cycle in [from, to], in order.
+        // stops early if visit returns false
+        void ForEach(uint64_t from, uint64_t to, const std::function<bool(const TraceRecord &)> &visit) const;
+
+    private:
+        struct Block
+        {
+            uint64_t FirstCycle;
+            uint64_t Offset;
+            uint32_t Records;
+        };
+
+        bool readIndex();
+        void scanBlocks();
+        // index of the last block starting at or before cycle, or blocks_.size()
+        size_t findBlock(uint64_t cycle) const;
+        const std::vector<TraceRecord> &decode(size_t block) const;
+
+        int fd_;
+        const uint8_t *data_;
+        size_t size_;
+        std::vector<Block> blocks_;
+        uint64_t recordCount_;
+        uint64_t lastCycle_;
+
+        // the most recently decoded block, sequential lookups mostly hit it
+        mutable size_t cachedBlock_;
+        mutable std::vector<TraceRecord> cachedRecords_;
+    };
+}
+
+#endif
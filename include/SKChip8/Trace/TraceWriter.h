@@ -0,0 +1,99 @@
+#ifndef _CHIP8_TRACE_WRITER_H_
+#define _CHIP8_TRACE_WRITER_H_
+
+#include "TraceFormat.h"
+
+#include <Emulator/Emulator.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SKChip8
+{
+    // streams trace records to a file. records are appended to a buffer owned
+    // by the producing thread with no locking; full buffers are handed to a
+    // background thread that encodes and writes them, then hands the buffer
+    // back for reuse. if the disk falls behind the producer blocks rather
+    // than buffering without bound. one writer per traced machine: cycles
+    // must never go backwards
+    class TraceWriter
+    {
+    public:
+        static constexpr size_t BLOCK_RECORDS = 1 << 16;
+        // buffers waiting to be written before Append blocks
+        static constexpr size_t MAX_PENDING_BLOCKS = 4;
+
+        explicit TraceWriter(const std::string &path);
+        // closes the trace if Close() wasn't called
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter &) = delete;
+        TraceWriter &operator=(const TraceWriter &) = delete;
+
+        void Append(const TraceRecord &record)
+        {
+            if (record.Cycle < lastCycle_)
+            {
+                throw std::invalid_argument("Trace cycles must not go backwards");
+            }
+            lastCycle_ = record.Cycle;
+
+            if (current_.size() == BLOCK_RECORDS)
+            {
+                submit();
+            }
+            current_.push_back(record);
+        }
+
+        // flushes everything, writes the index and stops the background
+        // thread. throws if any write failed
+        void Close();
+
+        uint64_t GetRecordCount() const { return submittedRecords_ + current_.size(); }
+        // encoded bytes written so far
+        uint64_t GetBytesWritten() const;
+
+    private:
+        struct IndexEntry
+        {
+            uint64_t FirstCycle;
+            uint64_t Offset;
+            uint32_t Records;
+        };
+
+        void submit();
+        void writerLoop();
+
+        std::ofstream file_;
+        std::vector<TraceRecord> current_;
+        uint64_t submittedRecords_;
+        uint64_t lastCycle_;
+
+        std::thread thread_;
+        mutable std::mutex mutex_;
+        std::condition_variable pendingChanged_;
+        std::deque<std::vector<TraceRecord>> pending_;
+        std::vector<std::vector<TraceRecord>> free_;
+        bool stopping_;
+        bool failed_;
+        bool closed_;
+
+        // owned by the background thread until it is joined
+        std::vector<uint8_t> encoded_;
+        std::vector<IndexEntry> index_;
+        uint64_t offset_;
+    };
+
+    // runs count instructions on emulator like Emulator::Run, appending a
+    // record for each to writer
+    void RunTraced(Emulator &emulator, uint64_t count, TraceWriter &writer);
+}
+
+#endif
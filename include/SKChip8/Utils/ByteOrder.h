@@ -0,0 +1,30 @@
+#ifndef _CHIP8_BYTE_ORDER_H_
+#define _CHIP8_BYTE_ORDER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SKChip8
+{
+    // little endian encoding for binary formats (save states, wire protocols)
+    // so that files and streams are portable between hosts
+    inline void StoreLE(uint8_t *out, uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            out[i] = (value >> (8 * i)) & 0xFF;
+        }
+    }
+
+    inline uint64_t LoadLE(const uint8_t *in, size_t bytes)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            value |= uint64_t(in[i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _CHIP8_DELTA_CODEC_H_
+#define _CHIP8_DELTA_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SKChip8
+{
+    // XOR + run-length delta encoding for snapshots of fixed size buffers
+    // (framebuffers, save states). the XOR of two similar buffers is mostly
+    // zeros, which encode as runs. each run starts with a control byte:
+    //   1nnnnnnn : n + 1 zero bytes
+    //   0nnnnnnn : n + 1 literal bytes follow
+    // a null previous buffer is treated as all zeros, which makes a keyframe
+
+    // appends the encoding of previous XOR current to out
+    void EncodeXorDelta(const uint8_t *previous, const uint8_t *current, size_t size, std::vector<uint8_t> &out);
+
+    // XORs an encoded delta into state (size bytes). returns the number of
+    // encoded bytes consumed, or 0 if the input is malformed
+    size_t ApplyXorDelta(const uint8_t *encoded, size_t encodedSize, uint8_t *state, size_t size);
+}
+
+#endif
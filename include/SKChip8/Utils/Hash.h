@@ -0,0 +1,24 @@
+#ifndef _CHIP8_HASH_H_
+#define _CHIP8_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SKChip8
+{
+    struct Hash128
+    {
+        uint64_t Low;
+        uint64_t High;
+
+        bool operator==(const Hash128 &other) const { return Low == other.Low && High == other.High; }
+        bool operator!=(const Hash128 &other) const { return !(*this == other); }
+    };
+
+    // fast non-cryptographic hashes, meant for state deduplication rather than
+    // anything adversarial. the result is stable across runs
+    uint64_t HashBytes(const void *data, size_t size, uint64_t seed = 0);
+    Hash128 HashBytes128(const void *data, size_t size, uint64_t seed = 0);
+}
+
+#endif
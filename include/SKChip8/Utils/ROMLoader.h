@@ -18,7 +18,8 @@ namespace SKChip8
 
         std::string getDisassembly() const;
         std::string getDump() const;
-        std::vector<uint8_t> getROM() const;
+        // the file's bytes, read once. share the loader rather than copying them
+        const std::vector<uint8_t> &getROM() const;
 
     private:
         std::string filename_;
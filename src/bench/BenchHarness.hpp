@@ -0,0 +1,158 @@
+#ifndef _BENCH_HARNESS_H
+#define _BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// minimal benchmark runner: each benchmark body runs a given number of
+// operations. the iteration count is grown until one run takes at least
+// MinTime (which doubles as warmup), a few more runs are discarded, then
+// Repetitions timed runs give the ns/op statistics
+
+struct BenchOptions
+{
+    std::chrono::nanoseconds MinTime = std::chrono::milliseconds(2);
+    int WarmupRuns = 2;
+    int Repetitions = 15;
+    std::string Filter;
+};
+
+struct BenchResult
+{
+    std::string Name;
+    // instructions executed per op, 0 if MIPS doesn't apply
+    double InstructionsPerOp;
+    uint64_t Iterations;
+    std::vector<double> NsPerOp;
+    double Median;
+    double P95;
+    double Min;
+    double Mean;
+
+    double MIPS() const { return InstructionsPerOp > 0 ? InstructionsPerOp * 1e3 / Median : 0.0; }
+};
+
+// written by benchmark bodies so the work can't be optimized away
+static volatile uint64_t benchSink;
+
+template <typename Body>
+bool runBenchmark(const BenchOptions &options, const std::string &name, double instructionsPerOp, Body &&body, BenchResult &result)
+{
+    if (!options.Filter.empty() && name.find(options.Filter) == std::string::npos)
+    {
+        return false;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto timeRun = [&body](uint64_t iterations)
+    {
+        const auto start = Clock::now();
+        body(iterations);
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    };
+
+    uint64_t iterations = 1;
+    while (timeRun(iterations) < options.MinTime && iterations < (uint64_t(1) << 40))
+    {
+        iterations *= 2;
+    }
+    for (int i = 0; i < options.WarmupRuns; ++i)
+    {
+        timeRun(iterations);
+    }
+
+    result.Name = name;
+    result.InstructionsPerOp = instructionsPerOp;
+    result.Iterations = iterations;
+    result.NsPerOp.clear();
+    for (int i = 0; i < options.Repetitions; ++i)
+    {
+        result.NsPerOp.push_back(static_cast<double>(timeRun(iterations).count()) / iterations);
+    }
+
+    auto sorted = result.NsPerOp;
+    std::sort(sorted.begin(), sorted.end());
+    result.Min = sorted.front();
+    result.Median = sorted[sorted.size() / 2];
+    result.P95 = sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.95))];
+    double sum = 0.0;
+    for (const auto ns : sorted)
+    {
+        sum += ns;
+    }
+    result.Mean = sum / sorted.size();
+    return true;
+}
+
+inline void printResult(const BenchResult &result)
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-44s %12.2f %12.2f %12.2f", result.Name.c_str(), result.Median, result.P95, result.Min);
+    std::printf("%s", line);
+    if (result.InstructionsPerOp > 0)
+    {
+        std::printf(" %10.2f", result.MIPS());
+    }
+    std::printf("\n");
+}
+
+inline std::string jsonEscape(const std::string &text)
+{
+    std::string escaped;
+    for (const auto c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+inline void writeJSON(std::ostream &os, const BenchOptions &options, const std::vector<BenchResult> &results)
+{
+    os << "{\n  \"context\": {\n";
+#ifdef __VERSION__
+    os << "    \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+#ifdef __OPTIMIZE__
+    os << "    \"optimized\": true,\n";
+#else
+    os << "    \"optimized\": false,\n";
+#endif
+#ifdef SKCHIP8_PROFILING
+    os << "    \"profiling\": true,\n";
+#else
+    os << "    \"profiling\": false,\n";
+#endif
+    os << "    \"repetitions\": " << options.Repetitions << ",\n"
+       << "    \"min_time_ns\": " << options.MinTime.count() << "\n  },\n"
+       << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &result = results[i];
+        os << (i ? ",\n" : "\n")
+           << "    {\"name\": \"" << jsonEscape(result.Name) << "\", \"iterations\": " << result.Iterations
+           << ", \"ns_per_op\": {\"median\": " << result.Median << ", \"p95\": " << result.P95
+           << ", \"min\": " << result.Min << ", \"mean\": " << result.Mean << "}";
+        if (result.InstructionsPerOp > 0)
+        {
+            os << ", \"mips\": " << result.MIPS();
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+#endif
@@ -0,0 +1,296 @@
+#include <SKChip8/Emulator/Emulator.h>
+#include <SKChip8/Emulator/Movie.h>
+
+#include "BenchHarness.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// end-to-end benchmark: plays every ROM in a directory headless and uncapped
+// with the same scripted input, one child process per ROM so that peak RSS
+// is per ROM:
+//   SKChip8MacroBench [--roms DIR] [--frames N] [--repetitions N] [--json FILE]
+// the seed and input are fixed, so the final hashes show whether two builds
+// did the same work. MIPS counts only instructions executed, cycles spent
+// halted on FX0A waiting for a key don't count
+
+namespace
+{
+    // keys held for SCRIPT_STEP_FRAMES frames each, then the script repeats.
+    // covers the usual controls: 4/6 left/right and 5 fire (Breakout, Space
+    // Invaders, Tetris), 1/4 and C/D paddles (Pong), 7 rotate (Tetris)
+    static constexpr uint16_t INPUT_SCRIPT[] = {
+        0,
+        1 << 0x4,
+        1 << 0x6,
+        1 << 0x5,
+        (1 << 0x4) | (1 << 0x5),
+        0,
+        (1 << 0x6) | (1 << 0x5),
+        1 << 0x1,
+        1 << 0xC,
+        1 << 0xD,
+        1 << 0x7,
+        1 << 0x0,
+    };
+    static constexpr uint64_t SCRIPT_STEP_FRAMES = 20;
+    static constexpr uint64_t INSTRUCTIONS_PER_FRAME = SKChip8::EMULATOR_CPU_HZ / 60;
+    static constexpr uint32_t SEED = 0xC8;
+
+    struct RunResult
+    {
+        double Seconds;
+        uint64_t Cycles;
+        // excludes cycles spent halted
+        uint64_t Instructions;
+        uint64_t Frames;
+        // frames that ended halted on FX0A
+        uint64_t HaltedFrames;
+        SKChip8::Hash128 StateHash;
+        uint64_t FrameHash;
+    };
+
+    struct ROMResult
+    {
+        std::string Name;
+        RunResult Run;
+        long PeakRSSKilobytes;
+        bool Ok;
+    };
+
+    RunResult playOnce(const std::string &rom, uint64_t frames)
+    {
+        SKChip8::Emulator emulator;
+        emulator.LoadProgram(rom);
+        emulator.SeedRandom(SEED);
+
+        const auto &cpu = emulator.GetCPU();
+        const auto scriptLength = sizeof(INPUT_SCRIPT) / sizeof(INPUT_SCRIPT[0]);
+        uint64_t haltedFrames = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < frames; ++frame)
+        {
+            emulator.SetKeyMask(INPUT_SCRIPT[(frame / SCRIPT_STEP_FRAMES) % scriptLength]);
+            emulator.Run(INSTRUCTIONS_PER_FRAME);
+            haltedFrames += cpu.IsHalted();
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return RunResult{seconds, emulator.GetCycleCount(), cpu.GetInstructionCount(), frames, haltedFrames,
+                         emulator.StateHash(), SKChip8::FrameHash(emulator)};
+    }
+
+    // runs the repetitions in a child and returns the fastest
+    ROMResult playInChild(const std::filesystem::path &rom, uint64_t frames, int repetitions)
+    {
+        ROMResult result{rom.filename().string(), RunResult{}, 0, false};
+
+        int fds[2];
+        if (::pipe(fds) != 0)
+        {
+            return result;
+        }
+
+        const auto pid = ::fork();
+        if (pid < 0)
+        {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return result;
+        }
+
+        if (pid == 0)
+        {
+            ::close(fds[0]);
+            RunResult best{};
+            bool ok = true;
+            try
+            {
+                for (int i = 0; i < repetitions; ++i)
+                {
+                    const auto run = playOnce(rom.string(), frames);
+                    if (i == 0 || run.Seconds < best.Seconds)
+                    {
+                        best = run;
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                // e.g. a ROM that overflows the call stack under this input
+                std::cerr << rom.filename().string() << ": " << e.what() << std::endl;
+                ok = false;
+            }
+
+            if (ok)
+            {
+                (void)!::write(fds[1], &best, sizeof(best));
+            }
+            ::close(fds[1]);
+            ::_exit(ok ? 0 : 1);
+        }
+
+        ::close(fds[1]);
+        const auto got = ::read(fds[0], &result.Run, sizeof(result.Run));
+        ::close(fds[0]);
+
+        int status = 0;
+        struct rusage usage;
+        ::wait4(pid, &status, 0, &usage);
+
+        // ru_maxrss is in kilobytes on Linux
+        result.PeakRSSKilobytes = usage.ru_maxrss;
+        result.Ok = got == static_cast<ssize_t>(sizeof(result.Run)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        return result;
+    }
+
+    std::string hex(uint64_t value)
+    {
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+        return text;
+    }
+
+    void writeMacroJSON(std::ostream &os, uint64_t frames, int repetitions, const std::vector<ROMResult> &results)
+    {
+        os << "{\n  \"context\": {\n";
+#ifdef __VERSION__
+        os << "    \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+#ifdef __OPTIMIZE__
+        os << "    \"optimized\": true,\n";
+#else
+        os << "    \"optimized\": false,\n";
+#endif
+        os << "    \"frames\": " << frames << ",\n"
+           << "    \"instructions_per_frame\": " << INSTRUCTIONS_PER_FRAME << ",\n"
+           << "    \"repetitions\": " << repetitions << ",\n"
+           << "    \"seed\": " << SEED << "\n  },\n"
+           << "  \"roms\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto &result = results[i];
+            os << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(result.Name) << "\", \"ok\": " << (result.Ok ? "true" : "false");
+            if (result.Ok)
+            {
+                const auto &run = result.Run;
+                os << ", \"seconds\": " << run.Seconds
+                   << ", \"cycles\": " << run.Cycles
+                   << ", \"instructions\": " << run.Instructions
+                   << ", \"halted_frames\": " << run.HaltedFrames
+                   << ", \"instructions_per_second\": " << run.Instructions / run.Seconds
+                   << ", \"frames_per_second\": " << run.Frames / run.Seconds
+                   << ", \"peak_rss_kb\": " << result.PeakRSSKilobytes
+                   << ", \"state_hash\": \"" << hex(run.StateHash.High) << hex(run.StateHash.Low) << "\""
+                   << ", \"frame_hash\": \"" << hex(run.FrameHash) << "\"";
+            }
+            os << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " [--roms DIR] [--frames N] [--repetitions N] [--json FILE]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string romDirectory = "../roms";
+    std::string jsonPath;
+    uint64_t frames = 500000;
+    int repetitions = 3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--roms") == 0 && hasValue)
+        {
+            romDirectory = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            frames = std::stoull(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+        {
+            repetitions = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::filesystem::path> roms;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(romDirectory, error))
+    {
+        if (entry.is_regular_file())
+        {
+            roms.push_back(entry.path());
+        }
+    }
+    std::sort(roms.begin(), roms.end());
+    if (roms.empty())
+    {
+        std::cerr << "no ROMs found in " << romDirectory << std::endl;
+        return 1;
+    }
+
+    std::printf("%-48s %10s %12s %10s %10s  %s\n", "rom", "MIPS", "frames/s", "RSS KB", "seconds", "frame hash");
+
+    std::vector<ROMResult> results;
+    bool allOk = true;
+    for (const auto &rom : roms)
+    {
+        const auto result = playInChild(rom, frames, repetitions);
+        results.push_back(result);
+        allOk = allOk && result.Ok;
+
+        if (!result.Ok)
+        {
+            std::printf("%-48s failed\n", result.Name.c_str());
+            continue;
+        }
+
+        const auto &run = result.Run;
+        std::printf("%-48s %10.2f %12.0f %10ld %10.3f  %s", result.Name.c_str(),
+                    run.Instructions / run.Seconds / 1e6, run.Frames / run.Seconds,
+                    result.PeakRSSKilobytes, run.Seconds, hex(run.FrameHash).c_str());
+        if (run.HaltedFrames != 0)
+        {
+            std::printf(" (%llu/%llu frames halted)", static_cast<unsigned long long>(run.HaltedFrames),
+                        static_cast<unsigned long long>(run.Frames));
+        }
+        std::printf("\n");
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        if (!json.is_open())
+        {
+            std::cerr << "Could not open file: " << jsonPath << std::endl;
+            return 1;
+        }
+        writeMacroJSON(json, frames, repetitions, results);
+    }
+
+    return allOk ? 0 : 1;
+}
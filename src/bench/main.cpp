@@ -0,0 +1,256 @@
+#include <SKChip8/Core/CPU.h>
+#include <SKChip8/Utils/CHIP8ISA.h>
+#include <SKChip8/Utils/ROMLoader.h>
+
+#include "BenchHarness.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// microbenchmarks for the core hot paths:
+//   SKChip8Bench [--filter TEXT] [--json FILE] [--repetitions N] [--min-time-ms N] [--roms DIR]
+// build with optimizations (CMAKE_BUILD_TYPE=Release), the JSON notes whether it was
+
+namespace
+{
+    // exposes drawSprite so it can be timed on its own
+    class BenchCPU : public SKChip8::CPU
+    {
+    public:
+        using SKChip8::CPU::drawSprite;
+    };
+
+    struct OpcodeMix
+    {
+        const char *Name;
+        // every program loops back to 0x200
+        std::vector<uint16_t> Program;
+    };
+
+    const std::vector<OpcodeMix> &opcodeMixes()
+    {
+        static const std::vector<OpcodeMix> mixes = {
+            {"alu", {0x6005, 0x6103, 0x8014, 0x8015, 0x8102, 0x8213, 0x8306, 0x7001, 0x1200}},
+            // every skip is taken except the last one
+            {"branch", {0x6000, 0x6100, 0x3000, 0x6001, 0x4001, 0x6001, 0x5010, 0x6001, 0x9010, 0x7000, 0x1200}},
+            {"memory", {0xA300, 0x60FF, 0xF033, 0xF355, 0xF365, 0xF01E, 0x1200}},
+            {"draw", {0xA000, 0x6008, 0x6104, 0xD015, 0x1200}},
+            {"call", {0x2204, 0x1200, 0x00EE}},
+            // roughly a game loop: move a sprite, random numbers, timers
+            {"mixed", {0xA000, 0x6A10, 0x6B08, 0xDAB5, 0x7A01, 0x4A40, 0x6A00, 0xC0FF, 0x8014, 0xF015, 0xF107, 0x3FFF, 0x1200}},
+        };
+        return mixes;
+    }
+
+    std::vector<uint8_t> assemble(const std::vector<uint16_t> &program)
+    {
+        std::vector<uint8_t> bytes;
+        for (const auto word : program)
+        {
+            bytes.push_back(static_cast<uint8_t>(word >> 8));
+            bytes.push_back(static_cast<uint8_t>(word));
+        }
+        return bytes;
+    }
+
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " [--filter TEXT] [--json FILE] [--repetitions N] [--min-time-ms N] [--roms DIR]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    std::string jsonPath;
+    std::string romDirectory = "../roms";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+        {
+            options.Filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+        {
+            options.Repetitions = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--min-time-ms") == 0 && hasValue)
+        {
+            options.MinTime = std::chrono::milliseconds(std::stoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--roms") == 0 && hasValue)
+        {
+            romDirectory = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    BenchResult result;
+    auto report = [&results, &result]()
+    {
+        printResult(result);
+        results.push_back(result);
+    };
+
+    std::printf("%-44s %12s %12s %12s %10s\n", "benchmark", "median ns", "p95 ns", "min ns", "MIPS");
+
+    for (const auto &mix : opcodeMixes())
+    {
+        SKChip8::CPU cpu;
+        cpu.SeedRandom(1);
+        cpu.LoadROM(assemble(mix.Program));
+        if (runBenchmark(options, std::string("CPU::Cycle/") + mix.Name, 1.0, [&cpu](uint64_t iterations)
+                         {
+                             for (uint64_t i = 0; i < iterations; ++i)
+                             {
+                                 cpu.Cycle();
+                             }
+                         },
+                         result))
+        {
+            report();
+        }
+    }
+
+    for (uint8_t height = 1; height <= 15; ++height)
+    {
+        for (uint8_t offset = 0; offset < 8; ++offset)
+        {
+            BenchCPU cpu;
+            const auto name = "drawSprite/x" + std::to_string(offset) + "/h" + std::to_string(height);
+            if (runBenchmark(options, name, 0.0, [&cpu, offset, height](uint64_t iterations)
+                             {
+                                 for (uint64_t i = 0; i < iterations; ++i)
+                                 {
+                                     cpu.drawSprite(offset, 0, height);
+                                 }
+                             },
+                             result))
+            {
+                report();
+            }
+        }
+    }
+
+    if (runBenchmark(options, "DecodeInstruction", 0.0, [](uint64_t iterations)
+                     {
+                         for (uint64_t i = 0; i < iterations; ++i)
+                         {
+                             benchSink = static_cast<uint64_t>(SKChip8::DecodeInstruction(static_cast<uint16_t>(i))->Type);
+                         }
+                     },
+                     result))
+    {
+        report();
+    }
+
+    {
+        SKChip8::CPU cpu;
+        cpu.LoadROM(assemble(opcodeMixes()[3].Program));
+        for (int i = 0; i < 64; ++i)
+        {
+            cpu.Cycle();
+        }
+
+        if (runBenchmark(options, "CPU::GetFrameBuffer", 0.0, [&cpu](uint64_t iterations)
+                         {
+                             for (uint64_t i = 0; i < iterations; ++i)
+                             {
+                                 benchSink = cpu.GetFrameBuffer()[4][8];
+                             }
+                         },
+                         result))
+        {
+            report();
+        }
+
+        // timers are at zero here, the common case between sounds
+        if (runBenchmark(options, "CPU::TimerTick", 0.0, [&cpu](uint64_t iterations)
+                         {
+                             for (uint64_t i = 0; i < iterations; ++i)
+                             {
+                                 cpu.TimerTick();
+                             }
+                         },
+                         result))
+        {
+            report();
+        }
+    }
+
+    std::vector<std::filesystem::path> roms;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(romDirectory, error))
+    {
+        if (entry.is_regular_file())
+        {
+            roms.push_back(entry.path());
+        }
+    }
+    std::sort(roms.begin(), roms.end());
+    if (roms.empty())
+    {
+        std::cerr << "no ROMs found in " << romDirectory << ", skipping disassembly benchmarks" << std::endl;
+    }
+
+    for (const auto &rom : roms)
+    {
+        const SKChip8::ROMLoader loader(rom.string());
+        if (runBenchmark(options, "ROMLoader::getDisassembly/" + rom.filename().string(), 0.0, [&loader](uint64_t iterations)
+                         {
+                             for (uint64_t i = 0; i < iterations; ++i)
+                             {
+                                 benchSink = loader.getDisassembly().size();
+                             }
+                         },
+                         result))
+        {
+            report();
+        }
+
+        // what Emulator::Reset pays for the ROM, straight out of the loader's buffer
+        if (loader.getROM().size() <= SKChip8::MAX_ROM_SIZE)
+        {
+            SKChip8::CPU cpu;
+            if (runBenchmark(options, "CPU::LoadROM/" + rom.filename().string(), 0.0, [&loader, &cpu](uint64_t iterations)
+                             {
+                                 for (uint64_t i = 0; i < iterations; ++i)
+                                 {
+                                     cpu.LoadROM(loader.getROM());
+                                 }
+                             },
+                             result))
+            {
+                report();
+            }
+        }
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        if (!json.is_open())
+        {
+            std::cerr << "Could not open file: " << jsonPath << std::endl;
+            return 1;
+        }
+        writeJSON(json, options, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "BroadcastServer.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace
+{
+    void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    sockaddr_un unixAddress(const std::string &path)
+    {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            throw std::invalid_argument("Socket path is too long: " + path);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, path.c_str());
+        return addr;
+    }
+
+    [[noreturn]] void throwSocketError(const std::string &what, int fd)
+    {
+        const std::string reason = std::strerror(errno);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error(what + ": " + reason);
+    }
+}
+
+namespace SKChip8
+{
+    BroadcastServer::BroadcastServer(const std::string &unixPath) : unixPath_(unixPath)
+    {
+        listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        auto addr = unixAddress(unixPath);
+        unlink(unixPath.c_str());
+        if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listenFd_, 64) < 0)
+        {
+            throwSocketError("Could not listen on " + unixPath, listenFd_);
+        }
+        setNonBlocking(listenFd_);
+    }
+
+    BroadcastServer::BroadcastServer(uint16_t tcpPort)
+    {
+        listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        int reuse = 1;
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(tcpPort);
+        if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listenFd_, 64) < 0)
+        {
+            throwSocketError("Could not listen on port " + std::to_string(tcpPort), listenFd_);
+        }
+        setNonBlocking(listenFd_);
+    }
+
+    BroadcastServer::~BroadcastServer()
+    {
+        for (auto &client : clients_)
+        {
+            close(client.Fd);
+        }
+        close(listenFd_);
+        if (!unixPath_.empty())
+        {
+            unlink(unixPath_.c_str());
+        }
+    }
+
+    void BroadcastServer::Publish(const EncodedFrame &message, bool keyframe)
+    {
+        if (keyframe)
+        {
+            sinceKeyframe_.clear();
+        }
+        if (!sinceKeyframe_.empty() || keyframe)
+        {
+            sinceKeyframe_.push_back(message);
+        }
+
+        for (auto &client : clients_)
+        {
+            client.Queue.push_back(message);
+        }
+    }
+
+    void BroadcastServer::acceptClients()
+    {
+        while (true)
+        {
+            const int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0)
+            {
+                return;
+            }
+
+            setNonBlocking(fd);
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            // start the newcomer from the latest keyframe
+            Client client{fd, {}, 0};
+            client.Queue.insert(client.Queue.end(), sinceKeyframe_.begin(), sinceKeyframe_.end());
+            clients_.push_back(std::move(client));
+        }
+    }
+
+    bool BroadcastServer::flush(Client &client)
+    {
+        if (client.Queue.size() > MAX_CLIENT_BACKLOG)
+        {
+            return false;
+        }
+
+        while (!client.Queue.empty())
+        {
+            const auto &message = *client.Queue.front();
+            const auto sent = send(client.Fd, message.data() + client.Offset, message.size() - client.Offset, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+
+            client.Offset += sent;
+            if (client.Offset < message.size())
+            {
+                return true;
+            }
+
+            client.Queue.pop_front();
+            client.Offset = 0;
+        }
+
+        return true;
+    }
+
+    void BroadcastServer::Pump()
+    {
+        acceptClients();
+
+        for (size_t i = 0; i < clients_.size();)
+        {
+            if (flush(clients_[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            close(clients_[i].Fd);
+            clients_[i] = std::move(clients_.back());
+            clients_.pop_back();
+        }
+    }
+
+    BroadcastClient::BroadcastClient(const std::string &unixPath)
+    {
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        auto addr = unixAddress(unixPath);
+        if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            throwSocketError("Could not connect to " + unixPath, fd_);
+        }
+    }
+
+    BroadcastClient::BroadcastClient(const std::string &host, uint16_t tcpPort)
+    {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(tcpPort);
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            close(fd_);
+            throw std::invalid_argument("Invalid IPv4 address: " + host);
+        }
+        if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            throwSocketError("Could not connect to " + host + ":" + std::to_string(tcpPort), fd_);
+        }
+    }
+
+    BroadcastClient::~BroadcastClient()
+    {
+        close(fd_);
+    }
+
+    bool BroadcastClient::readExactly(uint8_t *data, size_t size)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            const auto received = recv(fd_, data + done, size - done, 0);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                return false;
+            }
+            done += received;
+        }
+        return true;
+    }
+
+    bool BroadcastClient::Receive(FrameDecoder &decoder)
+    {
+        message_.resize(4);
+        if (!readExactly(message_.data(), 4))
+        {
+            return false;
+        }
+
+        const auto size = static_cast<uint32_t>(LoadLE(message_.data(), 4));
+        if (size > 2 * FRAME_BUFFER_SIZE + FRAME_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        message_.resize(4 + size);
+        return readExactly(message_.data() + 4, size) && decoder.Apply(message_.data(), message_.size());
+    }
+}
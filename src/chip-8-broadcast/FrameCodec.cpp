@@ -0,0 +1,130 @@
+#include "FrameCodec.h"
+
+#include <Utils/ByteOrder.h>
+#include <Utils/DeltaCodec.h>
+
+#include <cstring>
+
+namespace SKChip8
+{
+    FrameEncoder::FrameEncoder(uint32_t keyframeInterval) : keyframeInterval_(keyframeInterval > 0 ? keyframeInterval : 1),
+                                                            frame_(0),
+                                                            lastWasKeyframe_(false)
+    {
+        previous_.fill(0);
+        rows_.reserve(FRAME_BUFFER_SIZE);
+    }
+
+    EncodedFrame FrameEncoder::Encode(const CPU &cpu)
+    {
+        const auto &current = cpu.GetPackedFrameBuffer();
+        const bool keyframe = frame_ % keyframeInterval_ == 0;
+
+        auto message = std::make_shared<std::vector<uint8_t>>(FRAME_HEADER_SIZE);
+        auto &bytes = *message;
+
+        uint32_t rowMask = 0;
+        if (keyframe)
+        {
+            rowMask = ~0u;
+            EncodeXorDelta(nullptr, current.data(), current.size(), bytes);
+        }
+        else
+        {
+            // gather the XOR of every row that changed, then run-length encode it
+            rows_.clear();
+            for (size_t row = 0; row < SCR_HEIGHT; ++row)
+            {
+                const auto offset = row * FRAME_ROW_BYTES;
+                if (std::memcmp(current.data() + offset, previous_.data() + offset, FRAME_ROW_BYTES) != 0)
+                {
+                    rowMask |= 1u << row;
+                    for (size_t i = 0; i < FRAME_ROW_BYTES; ++i)
+                    {
+                        rows_.push_back(current[offset + i] ^ previous_[offset + i]);
+                    }
+                }
+            }
+            EncodeXorDelta(nullptr, rows_.data(), rows_.size(), bytes);
+        }
+
+        StoreLE(bytes.data(), static_cast<uint32_t>(bytes.size() - 4), 4);
+        bytes[4] = static_cast<uint8_t>(keyframe ? FrameMessageType::Keyframe : FrameMessageType::Delta);
+        StoreLE(bytes.data() + 5, frame_, 4);
+        bytes[9] = cpu.GetSoundTimer();
+        StoreLE(bytes.data() + 10, rowMask, 4);
+
+        previous_ = current;
+        lastWasKeyframe_ = keyframe;
+        frame_++;
+        return message;
+    }
+
+    FrameDecoder::FrameDecoder() : hasKeyframe_(false), frame_(0), soundTimer_(0)
+    {
+        frameBuffer_.fill(0);
+    }
+
+    bool FrameDecoder::Apply(const uint8_t *message, size_t size)
+    {
+        if (size < FRAME_HEADER_SIZE || static_cast<uint32_t>(LoadLE(message, 4)) != size - 4)
+        {
+            return false;
+        }
+
+        const auto type = FrameMessageType(message[4]);
+        const auto rowMask = static_cast<uint32_t>(LoadLE(message + 10, 4));
+        const auto payload = message + FRAME_HEADER_SIZE;
+        const auto payloadSize = size - FRAME_HEADER_SIZE;
+
+        if (type == FrameMessageType::Keyframe)
+        {
+            frameBuffer_.fill(0);
+            if (!ApplyXorDelta(payload, payloadSize, frameBuffer_.data(), frameBuffer_.size()))
+            {
+                return false;
+            }
+            hasKeyframe_ = true;
+        }
+        else if (type == FrameMessageType::Delta)
+        {
+            if (!hasKeyframe_)
+            {
+                return true;
+            }
+
+            size_t changedRows = 0;
+            for (auto mask = rowMask; mask != 0; mask &= mask - 1)
+            {
+                changedRows++;
+            }
+
+            rows_.assign(FRAME_ROW_BYTES * changedRows, 0);
+            if (!rows_.empty() && !ApplyXorDelta(payload, payloadSize, rows_.data(), rows_.size()))
+            {
+                return false;
+            }
+
+            size_t changed = 0;
+            for (size_t row = 0; row < SCR_HEIGHT; ++row)
+            {
+                if (rowMask & (1u << row))
+                {
+                    for (size_t i = 0; i < FRAME_ROW_BYTES; ++i)
+                    {
+                        frameBuffer_[row * FRAME_ROW_BYTES + i] ^= rows_[changed * FRAME_ROW_BYTES + i];
+                    }
+                    changed++;
+                }
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        frame_ = static_cast<uint32_t>(LoadLE(message + 5, 4));
+        soundTimer_ = message[9];
+        return true;
+    }
+}
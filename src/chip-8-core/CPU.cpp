@@ -1,11 +1,15 @@
 #include "CPU.h"
 
+#include <Utils/ByteOrder.h>
 #include <Utils/CHIP8Utils.h>
 
 #include <cstdlib>
 #include <ctime>
 #include <cstring>
 #include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
 static constexpr uint16_t FONT_BYTES = 5;
 static constexpr uint16_t FONT_DATA_SIZE = FONT_BYTES * 16;
@@ -71,10 +75,12 @@ namespace
 
 namespace SKChip8
 {
+    static_assert(std::is_trivially_copyable<CPU>::value, "CPU must stay cheap to copy");
+
     CPU::CPU()
     {
         // initialize timers, peripherals, etc.
-        std::srand(std::time(0));
+        SeedRandom(static_cast<uint32_t>(std::time(0)));
 
         // store the font data in memory, and set the rest to zero just to be safe
         std::memset(memory_.data(), 0, memory_.size());
@@ -89,11 +95,43 @@ namespace SKChip8
         delayTimer_ = 0;
         soundTimer_ = 0;
         systemClock_ = 0;
+        instructionCount_ = 0;
+
+        indexRegister_ = 0;
+        programCounter_ = PROG_MEMORY_OFFSET;
+        shouldIncrementPC_ = true;
+        stackPointer_ = 0;
+        registerAwaitingKey_ = 0;
+        externState_ = 0;
+
+        std::memset(memoryPageHashes_.data(), 0, sizeof(memoryPageHashes_));
+        dirtyMemoryPages_ = 0xFFFF;
+    }
+
+    void CPU::SeedRandom(uint32_t seed)
+    {
+        // xorshift gets stuck at zero
+        randomState_ = seed != 0 ? seed : 0x9E3779B9;
+    }
+
+    uint8_t CPU::nextRandom()
+    {
+        randomState_ ^= randomState_ << 13;
+        randomState_ ^= randomState_ >> 17;
+        randomState_ ^= randomState_ << 5;
+        return randomState_ & 0xFF;
     }
 
-    void CPU::LoadROM(std::vector<uint8_t> buffer)
+    void CPU::LoadROM(const uint8_t *data, size_t size)
     {
-        std::copy(buffer.begin(), buffer.end(), memory_.begin() + PROG_MEMORY_OFFSET);
+        if (size > MAX_ROM_SIZE)
+        {
+            throw std::invalid_argument("ROM is " + std::to_string(size) + " bytes, at most " +
+                                        std::to_string(MAX_ROM_SIZE) + " fit in program memory");
+        }
+
+        std::copy(data, data + size, memory_.begin() + PROG_MEMORY_OFFSET);
+        markMemoryDirty(PROG_MEMORY_OFFSET, static_cast<uint16_t>(size));
         programCounter_ = PROG_MEMORY_OFFSET;
         shouldIncrementPC_ = true;
     }
@@ -107,6 +145,9 @@ namespace SKChip8
     {
         const uint8_t offset = x % 8;
         bool collision = false;
+#ifdef SKCHIP8_PROFILING
+        heatmap_.Read(indexRegister_, n);
+#endif
         for (size_t idx = 0; idx < n; ++idx)
         {
             const auto &row = memory_[indexRegister_ + idx];
@@ -158,6 +199,43 @@ namespace SKChip8
         registerFile_[VF_] = collision ? 1 : 0;
     }
 
+    void CPU::markMemoryDirty(uint16_t address, uint16_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        const size_t first = (address / MEMORY_PAGE_SIZE) % MEMORY_PAGE_COUNT;
+        const size_t last = ((address + size - 1) / MEMORY_PAGE_SIZE) % MEMORY_PAGE_COUNT;
+        for (size_t page = first;; page = (page + 1) % MEMORY_PAGE_COUNT)
+        {
+            dirtyMemoryPages_ |= 1 << page;
+            if (page == last)
+            {
+                break;
+            }
+        }
+    }
+
+    void CPU::pushStack(uint16_t address)
+    {
+        if (stackPointer_ >= STACK_DEPTH)
+        {
+            throw std::runtime_error("Call stack overflow");
+        }
+        callStack_[stackPointer_++] = address;
+    }
+
+    uint16_t CPU::popStack()
+    {
+        if (stackPointer_ == 0)
+        {
+            throw std::runtime_error("Call stack underflow");
+        }
+        return callStack_[--stackPointer_];
+    }
+
     void CPU::handleInstruction(Instruction &inst)
     {
         using InstructionType = Instruction::InstructionType;
@@ -170,7 +248,7 @@ namespace SKChip8
             shouldIncrementPC_ = false;
             break;
         case InstructionType::Call:
-            callStack_.push(programCounter_ + 2);
+            pushStack(programCounter_ + 2);
             programCounter_ = inst.Address();
             shouldIncrementPC_ = false;
             break;
@@ -216,7 +294,7 @@ namespace SKChip8
             shouldIncrementPC_ = false;
             break;
         case InstructionType::RegisterMaskedRandom:
-            registerFile_[inst.RegisterX()] = std::rand() & inst.Immediate();
+            registerFile_[inst.RegisterX()] = nextRandom() & inst.Immediate();
             break;
         case InstructionType::DrawSprite:
             // coordinates wrap around the screen
@@ -233,7 +311,7 @@ namespace SKChip8
         switch (inst.Type)
         {
         case InstructionType::MachineCall:
-            callStack_.push(programCounter_ + 2);
+            pushStack(programCounter_ + 2);
             programCounter_ = inst.Address();
             shouldIncrementPC_ = false;
             break;
@@ -241,8 +319,7 @@ namespace SKChip8
             std::memset(frameBuffer_.data(), 0, frameBuffer_.size());
             break;
         case InstructionType::Return:
-            programCounter_ = callStack_.top();
-            callStack_.pop();
+            programCounter_ = popStack();
             shouldIncrementPC_ = false;
             break;
         }
@@ -345,17 +422,28 @@ namespace SKChip8
             memory_[indexRegister_ + 0] = reg / 100;
             memory_[indexRegister_ + 1] = (reg / 10) % 10;
             memory_[indexRegister_ + 2] = reg % 10;
+            markMemoryDirty(indexRegister_, 3);
+#ifdef SKCHIP8_PROFILING
+            heatmap_.Write(indexRegister_, 3);
+#endif
             break;
         }
         case InstructionType::RegisterDump:
             std::copy(registerFile_.begin(),
                       registerFile_.begin() + inst.RegisterX() + 1,
                       memory_.begin() + indexRegister_);
+            markMemoryDirty(indexRegister_, inst.RegisterX() + 1);
+#ifdef SKCHIP8_PROFILING
+            heatmap_.Write(indexRegister_, inst.RegisterX() + 1);
+#endif
             break;
         case InstructionType::RegisterRestore:
             std::copy(memory_.begin() + indexRegister_,
                       memory_.begin() + indexRegister_ + inst.RegisterX() + 1,
                       registerFile_.begin());
+#ifdef SKCHIP8_PROFILING
+            heatmap_.Read(indexRegister_, inst.RegisterX() + 1);
+#endif
             break;
         }
     }
@@ -392,7 +480,6 @@ namespace SKChip8
 
     void CPU::Cycle()
     {
-        // std::cerr << DumpState() << std::endl;
         systemClock_++;
 
         if (halted_)
@@ -401,6 +488,7 @@ namespace SKChip8
             {
                 return;
             }
+            externState_ &= ~KEYBOARD_DIRTY_BIT;
 
             auto it = std::find(keyState_.begin(), keyState_.end(), true);
             if (it != keyState_.end())
@@ -413,6 +501,14 @@ namespace SKChip8
                 return;
             }
         }
+        instructionCount_++;
+
+#ifdef SKCHIP8_PROFILING
+        const auto profileStart = ExecutionProfile::Clock::now();
+        const auto profilePC = programCounter_;
+        const auto profileStackPointer = stackPointer_;
+        heatmap_.Execute(programCounter_);
+#endif
 
         auto instr_raw = currentInstruction();
         auto instr = DecodeInstruction(instr_raw);
@@ -445,11 +541,393 @@ namespace SKChip8
         {
             shouldIncrementPC_ = true;
         }
+
+#ifdef SKCHIP8_PROFILING
+        profile_.Record(profilePC, instr_raw, ExecutionProfile::Clock::now() - profileStart);
+
+        // the CALL itself counts for the caller and the RET for the callee.
+        // going by the stack rather than the opcode covers machine calls
+        // (0NNN) as well as 2NNN, whatever the decoder treats as one
+        callGraph_.Tick();
+        if (stackPointer_ > profileStackPointer)
+        {
+            callGraph_.Enter(programCounter_);
+        }
+        else if (stackPointer_ < profileStackPointer)
+        {
+            callGraph_.Leave();
+        }
+#endif
     }
 
     void CPU::SetKeyState(uint8_t key, bool state)
     {
-        keyState_[key] = state;
+        if (keyState_[key] != state)
+        {
+            keyState_[key] = state;
+            externState_ |= KEYBOARD_DIRTY_BIT;
+        }
+    }
+
+    Hash128 CPU::StateHash() const
+    {
+        for (size_t page = 0; dirtyMemoryPages_ != 0; ++page)
+        {
+            if (dirtyMemoryPages_ & (1 << page))
+            {
+                memoryPageHashes_[page] = HashBytes128(memory_.data() + page * MEMORY_PAGE_SIZE, MEMORY_PAGE_SIZE, page);
+                dirtyMemoryPages_ &= ~(1 << page);
+            }
+        }
+
+        // gather everything into one contiguous buffer and hash it in one go
+        struct
+        {
+            std::array<Hash128, MEMORY_PAGE_COUNT> pages;
+            std::array<uint8_t, FRAME_BUFFER_SIZE> frameBuffer;
+            std::array<uint16_t, STACK_DEPTH> stack;
+            std::array<uint8_t, REG_COUNT> registers;
+            uint32_t random;
+            uint16_t index;
+            uint16_t pc;
+            uint8_t stackPointer;
+            uint8_t delay;
+            uint8_t sound;
+            uint8_t halted;
+            uint8_t awaitingKey;
+        } state;
+
+        // zero the padding so it doesn't leak into the hash
+        std::memset(&state, 0, sizeof(state));
+        state.pages = memoryPageHashes_;
+        state.frameBuffer = frameBuffer_;
+        std::copy(callStack_.begin(), callStack_.begin() + stackPointer_, state.stack.begin());
+        state.registers = registerFile_;
+        state.random = randomState_;
+        state.index = indexRegister_;
+        state.pc = programCounter_;
+        state.stackPointer = stackPointer_;
+        state.delay = delayTimer_;
+        state.sound = soundTimer_;
+        state.halted = halted_ ? 1 : 0;
+        state.awaitingKey = halted_ ? registerAwaitingKey_ : 0;
+
+        return HashBytes128(&state, sizeof(state));
+    }
+
+    void CPU::SaveState(uint8_t *out) const
+    {
+        std::memcpy(out, memory_.data(), memory_.size());
+        out += memory_.size();
+        std::memcpy(out, frameBuffer_.data(), frameBuffer_.size());
+        out += frameBuffer_.size();
+        std::memcpy(out, registerFile_.data(), registerFile_.size());
+        out += registerFile_.size();
+        for (size_t key = 0; key < KEY_COUNT; ++key)
+        {
+            *out++ = keyState_[key] ? 1 : 0;
+        }
+        for (size_t i = 0; i < STACK_DEPTH; ++i, out += 2)
+        {
+            StoreLE(out, callStack_[i], 2);
+        }
+        *out++ = stackPointer_;
+
+        StoreLE(out, indexRegister_, 2);
+        StoreLE(out + 2, programCounter_, 2);
+        out += 4;
+        *out++ = shouldIncrementPC_ ? 1 : 0;
+
+        *out++ = delayTimer_;
+        *out++ = soundTimer_;
+        *out++ = halted_ ? 1 : 0;
+        *out++ = registerAwaitingKey_;
+
+        StoreLE(out, randomState_, 4);
+        StoreLE(out + 4, systemClock_, 8);
+        out += 12;
+        *out++ = externState_;
+    }
+
+    void CPU::LoadState(const uint8_t *in)
+    {
+        // addresses are used to index memory_ unchecked, so validate them
+        // before touching anything. PC needs room for both opcode bytes, and
+        // live return addresses become PC on RET
+        const uint8_t *addresses = in + CHIP8_MEM_SIZE + FRAME_BUFFER_SIZE + REG_COUNT + KEY_COUNT;
+        const auto stackPointer = std::min<uint8_t>(addresses[2 * STACK_DEPTH], STACK_DEPTH);
+        for (size_t i = 0; i < stackPointer; ++i)
+        {
+            if (LoadLE(addresses + 2 * i, 2) >= CHIP8_MEM_SIZE - 1)
+            {
+                throw std::runtime_error("Corrupt save state: return address out of memory");
+            }
+        }
+        addresses += 2 * STACK_DEPTH + 1;
+        if (LoadLE(addresses, 2) >= CHIP8_MEM_SIZE)
+        {
+            throw std::runtime_error("Corrupt save state: I out of memory");
+        }
+        if (LoadLE(addresses + 2, 2) >= CHIP8_MEM_SIZE - 1)
+        {
+            throw std::runtime_error("Corrupt save state: PC out of memory");
+        }
+
+        std::memcpy(memory_.data(), in, memory_.size());
+        in += memory_.size();
+        std::memcpy(frameBuffer_.data(), in, frameBuffer_.size());
+        in += frameBuffer_.size();
+        std::memcpy(registerFile_.data(), in, registerFile_.size());
+        in += registerFile_.size();
+        for (size_t key = 0; key < KEY_COUNT; ++key)
+        {
+            keyState_[key] = *in++ != 0;
+        }
+        for (size_t i = 0; i < STACK_DEPTH; ++i, in += 2)
+        {
+            callStack_[i] = static_cast<uint16_t>(LoadLE(in, 2));
+        }
+        stackPointer_ = std::min<uint8_t>(*in++, STACK_DEPTH);
+
+        indexRegister_ = static_cast<uint16_t>(LoadLE(in, 2));
+        programCounter_ = static_cast<uint16_t>(LoadLE(in + 2, 2));
+        in += 4;
+        shouldIncrementPC_ = *in++ != 0;
+
+        delayTimer_ = *in++;
+        soundTimer_ = *in++;
+        halted_ = *in++ != 0;
+        registerAwaitingKey_ = *in++ % REG_COUNT;
+
+        randomState_ = static_cast<uint32_t>(LoadLE(in, 4));
+        systemClock_ = LoadLE(in + 4, 8);
+        in += 12;
+        externState_ = *in++;
+
+        // the whole memory may have changed
+        dirtyMemoryPages_ = 0xFFFF;
+    }
+
+    void CPU::recordUndoSpan(std::vector<uint8_t> &out, UndoTarget target, size_t offset, size_t size) const
+    {
+        const uint8_t *source = nullptr;
+        size_t limit = 0;
+        switch (target)
+        {
+        case UndoTarget::Memory:
+            source = memory_.data();
+            limit = memory_.size();
+            break;
+        case UndoTarget::FrameBuffer:
+            source = frameBuffer_.data();
+            limit = frameBuffer_.size();
+            break;
+        case UndoTarget::Stack:
+            source = reinterpret_cast<const uint8_t *>(callStack_.data());
+            limit = sizeof(callStack_);
+            break;
+        }
+
+        // writes past the end are not undoable, clip to what exists
+        if (offset >= limit)
+        {
+            return;
+        }
+        size = std::min(size, limit - offset);
+
+        uint8_t header[UNDO_SPAN_HEADER_SIZE];
+        header[0] = static_cast<uint8_t>(target);
+        StoreLE(header + 1, offset, 2);
+        StoreLE(header + 3, size, 2);
+        out.insert(out.end(), header, header + sizeof(header));
+        out.insert(out.end(), source + offset, source + offset + size);
+    }
+
+    size_t CPU::PendingMemoryAccesses(std::array<MemoryAccess, MAX_MEMORY_ACCESSES> &out) const
+    {
+        // mirrors the start of Cycle(): a halted CPU only runs the next
+        // instruction in the cycle its key arrives
+        if (halted_ && (!isKeyboardDirty() || std::find(keyState_.begin(), keyState_.end(), true) == keyState_.end()))
+        {
+            return 0;
+        }
+
+        size_t count = 0;
+        out[count++] = MemoryAccess{programCounter_, 2, false};
+
+        const auto opcode = currentInstruction();
+        const uint16_t registerCount = ((opcode >> 8) & 0xF) + 1;
+        if ((opcode >> 12) == 0xD)
+        {
+            out[count++] = MemoryAccess{indexRegister_, static_cast<uint16_t>(opcode & 0xF), false};
+        }
+        else if ((opcode & 0xF0FF) == 0xF033)
+        {
+            out[count++] = MemoryAccess{indexRegister_, 3, true};
+        }
+        else if ((opcode & 0xF0FF) == 0xF055)
+        {
+            out[count++] = MemoryAccess{indexRegister_, registerCount, true};
+        }
+        else if ((opcode & 0xF0FF) == 0xF065)
+        {
+            out[count++] = MemoryAccess{indexRegister_, registerCount, false};
+        }
+        return count;
+    }
+
+    void CPU::RecordUndo(std::vector<uint8_t> &out) const
+    {
+        uint8_t scalars[UNDO_SCALARS_SIZE];
+        auto cursor = scalars;
+        std::memcpy(cursor, registerFile_.data(), registerFile_.size());
+        cursor += registerFile_.size();
+        for (size_t key = 0; key < KEY_COUNT; ++key)
+        {
+            *cursor++ = keyState_[key] ? 1 : 0;
+        }
+        StoreLE(cursor, indexRegister_, 2);
+        StoreLE(cursor + 2, programCounter_, 2);
+        cursor += 4;
+        *cursor++ = shouldIncrementPC_ ? 1 : 0;
+        *cursor++ = stackPointer_;
+        *cursor++ = delayTimer_;
+        *cursor++ = soundTimer_;
+        *cursor++ = halted_ ? 1 : 0;
+        *cursor++ = registerAwaitingKey_;
+        StoreLE(cursor, randomState_, 4);
+        StoreLE(cursor + 4, systemClock_, 8);
+        cursor += 12;
+        *cursor++ = externState_;
+        out.insert(out.end(), scalars, cursor);
+
+        // a push only overwrites the slot above the top, pops just move the pointer
+        if (stackPointer_ < STACK_DEPTH)
+        {
+            recordUndoSpan(out, UndoTarget::Stack, stackPointer_ * sizeof(uint16_t), sizeof(uint16_t));
+        }
+
+        // everything else is decided by the instruction about to run. a halted
+        // CPU that gets its key runs it in the same cycle, so this covers that too
+        const auto opcode = currentInstruction();
+        switch (opcode >> 12)
+        {
+        case 0x0:
+            if (opcode == 0x00E0)
+            {
+                recordUndoSpan(out, UndoTarget::FrameBuffer, 0, FRAME_BUFFER_SIZE);
+            }
+            break;
+        case 0xD:
+        {
+            // the rows drawn plus the byte a sprite in the last column spills into
+            const auto y = registerFile_[(opcode >> 4) & 0xF] % SCR_HEIGHT;
+            const auto rows = opcode & 0xF;
+            recordUndoSpan(out, UndoTarget::FrameBuffer, flattenedFrameBufferIndex(0, y), (SCR_WIDTH / 8) * rows + 1);
+            break;
+        }
+        case 0xF:
+            if ((opcode & 0xFF) == 0x33)
+            {
+                recordUndoSpan(out, UndoTarget::Memory, indexRegister_, 3);
+            }
+            else if ((opcode & 0xFF) == 0x55)
+            {
+                recordUndoSpan(out, UndoTarget::Memory, indexRegister_, ((opcode >> 8) & 0xF) + 1);
+            }
+            break;
+        }
+    }
+
+    void CPU::ApplyUndo(const uint8_t *record, size_t size)
+    {
+        if (size < UNDO_SCALARS_SIZE)
+        {
+            throw std::runtime_error("Undo record is truncated");
+        }
+
+        // check the spans before touching anything
+        for (size_t at = UNDO_SCALARS_SIZE; at < size;)
+        {
+            if (size - at < UNDO_SPAN_HEADER_SIZE)
+            {
+                throw std::runtime_error("Undo record is corrupt");
+            }
+
+            const auto offset = LoadLE(record + at + 1, 2);
+            const auto spanSize = LoadLE(record + at + 3, 2);
+            at += UNDO_SPAN_HEADER_SIZE;
+
+            size_t limit = 0;
+            switch (static_cast<UndoTarget>(record[at - UNDO_SPAN_HEADER_SIZE]))
+            {
+            case UndoTarget::Memory:
+                limit = memory_.size();
+                break;
+            case UndoTarget::FrameBuffer:
+                limit = frameBuffer_.size();
+                break;
+            case UndoTarget::Stack:
+                limit = sizeof(callStack_);
+                break;
+            }
+
+            if (limit == 0 || size - at < spanSize || offset + spanSize > limit)
+            {
+                throw std::runtime_error("Undo record is corrupt");
+            }
+            at += spanSize;
+        }
+
+        auto cursor = record;
+        std::memcpy(registerFile_.data(), cursor, registerFile_.size());
+        cursor += registerFile_.size();
+        for (size_t key = 0; key < KEY_COUNT; ++key)
+        {
+            keyState_[key] = *cursor++ != 0;
+        }
+        indexRegister_ = static_cast<uint16_t>(LoadLE(cursor, 2));
+        programCounter_ = static_cast<uint16_t>(LoadLE(cursor + 2, 2));
+        cursor += 4;
+        shouldIncrementPC_ = *cursor++ != 0;
+        stackPointer_ = std::min<uint8_t>(*cursor++, STACK_DEPTH);
+        delayTimer_ = *cursor++;
+        soundTimer_ = *cursor++;
+        halted_ = *cursor++ != 0;
+        registerAwaitingKey_ = *cursor++ % REG_COUNT;
+        randomState_ = static_cast<uint32_t>(LoadLE(cursor, 4));
+        systemClock_ = LoadLE(cursor + 4, 8);
+        cursor += 12;
+        externState_ = *cursor++;
+
+        while (cursor < record + size)
+        {
+            const auto target = static_cast<UndoTarget>(cursor[0]);
+            const auto offset = static_cast<size_t>(LoadLE(cursor + 1, 2));
+            const auto spanSize = static_cast<size_t>(LoadLE(cursor + 3, 2));
+            cursor += UNDO_SPAN_HEADER_SIZE;
+
+            uint8_t *destination = nullptr;
+            switch (target)
+            {
+            case UndoTarget::Memory:
+                destination = memory_.data();
+                break;
+            case UndoTarget::FrameBuffer:
+                destination = frameBuffer_.data();
+                break;
+            case UndoTarget::Stack:
+                destination = reinterpret_cast<uint8_t *>(callStack_.data());
+                break;
+            }
+
+            std::memcpy(destination + offset, cursor, spanSize);
+            if (target == UndoTarget::Memory)
+            {
+                markMemoryDirty(static_cast<uint16_t>(offset), static_cast<uint16_t>(spanSize));
+            }
+            cursor += spanSize;
+        }
     }
 
     std::string CPU::dumpSpecial() const
@@ -520,12 +998,9 @@ namespace SKChip8
     std::string CPU::dumpStack() const
     {
         std::stringstream ss;
-        std::stack<uint16_t> stack(callStack_);
-        for (size_t i = 0; i < stack.size(); ++i)
+        for (size_t i = stackPointer_; i > 0; --i)
         {
-            auto val = stack.top();
-            stack.pop();
-            ss << WordPrinter(val) << "\n";
+            ss << WordPrinter(callStack_[i - 1]) << "\n";
         }
 
         return ss.str();
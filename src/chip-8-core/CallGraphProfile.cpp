@@ -0,0 +1,142 @@
+#include "CallGraphProfile.h"
+#include "CPU.h"
+
+#include <iomanip>
+#include <map>
+
+namespace SKChip8
+{
+    void CallGraphProfile::Clear()
+    {
+        Nodes[ROOT] = Node{PROG_MEMORY_OFFSET, NONE, NONE, NONE, 0, 0};
+        NodeCount = 1;
+        Current = ROOT;
+        OverflowDepth = 0;
+    }
+
+    void CallGraphProfile::Enter(uint16_t address)
+    {
+        if (OverflowDepth > 0)
+        {
+            OverflowDepth++;
+            return;
+        }
+
+        // callers rarely have more than a handful of callees, so a list will do
+        uint16_t child = Nodes[Current].FirstChild;
+        while (child != NONE && Nodes[child].Address != address)
+        {
+            child = Nodes[child].NextSibling;
+        }
+
+        if (child == NONE)
+        {
+            if (NodeCount == CALL_GRAPH_NODE_COUNT)
+            {
+                OverflowDepth = 1;
+                return;
+            }
+
+            child = NodeCount++;
+            Nodes[child] = Node{address, Current, NONE, Nodes[Current].FirstChild, 0, 0};
+            Nodes[Current].FirstChild = child;
+        }
+
+        Nodes[child].Calls++;
+        Current = child;
+    }
+
+    void CallGraphProfile::Leave()
+    {
+        if (OverflowDepth > 0)
+        {
+            OverflowDepth--;
+        }
+        else if (Current != ROOT)
+        {
+            Current = Nodes[Current].Parent;
+        }
+    }
+
+    uint64_t CallGraphProfile::GetTotalCycles() const
+    {
+        uint64_t total = 0;
+        for (size_t node = 0; node < NodeCount; ++node)
+        {
+            total += Nodes[node].ExclusiveCycles;
+        }
+        return total;
+    }
+
+    std::vector<CallGraphProfile::SubroutineStats> CallGraphProfile::GetSubroutineStats() const
+    {
+        // nodes are created after their parents, so one backwards pass
+        // accumulates every subtree
+        std::vector<uint64_t> subtreeCycles(NodeCount);
+        for (size_t node = NodeCount; node-- > 0;)
+        {
+            subtreeCycles[node] += Nodes[node].ExclusiveCycles;
+            if (node != ROOT)
+            {
+                subtreeCycles[Nodes[node].Parent] += subtreeCycles[node];
+            }
+        }
+
+        std::map<uint16_t, SubroutineStats> byAddress;
+        for (size_t node = 0; node < NodeCount; ++node)
+        {
+            const auto &current = Nodes[node];
+            auto &stats = byAddress.emplace(current.Address, SubroutineStats{current.Address, 0, 0, 0}).first->second;
+            stats.Calls += current.Calls;
+            stats.ExclusiveCycles += current.ExclusiveCycles;
+
+            // a recursive call is already inside an outer call's subtree
+            bool recursive = false;
+            for (auto ancestor = current.Parent; ancestor != NONE; ancestor = Nodes[ancestor].Parent)
+            {
+                if (Nodes[ancestor].Address == current.Address)
+                {
+                    recursive = true;
+                    break;
+                }
+            }
+            if (!recursive)
+            {
+                stats.InclusiveCycles += subtreeCycles[node];
+            }
+        }
+
+        std::vector<SubroutineStats> result;
+        result.reserve(byAddress.size());
+        for (const auto &kv : byAddress)
+        {
+            result.push_back(kv.second);
+        }
+        return result;
+    }
+
+    void CallGraphProfile::WriteCollapsed(std::ostream &os) const
+    {
+        std::vector<uint16_t> path;
+        for (size_t node = 0; node < NodeCount; ++node)
+        {
+            if (Nodes[node].ExclusiveCycles == 0)
+            {
+                continue;
+            }
+
+            path.clear();
+            for (auto frame = static_cast<uint16_t>(node); frame != NONE; frame = Nodes[frame].Parent)
+            {
+                path.push_back(Nodes[frame].Address);
+            }
+
+            for (auto it = path.rbegin(); it != path.rend(); ++it)
+            {
+                os << (it == path.rbegin() ? "" : ";") << "0x" << std::hex << std::uppercase
+                   << std::setw(3) << std::setfill('0') << *it;
+            }
+            os << std::dec << std::setfill(' ') << " " << Nodes[node].ExclusiveCycles << "\n";
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include "ExecutionProfile.h"
+
+#include <iomanip>
+
+namespace SKChip8
+{
+    static constexpr const char *OPCODE_CLASS_NAMES[OPCODE_CLASS_COUNT] = {
+        "SYS/CLS/RET", // 0
+        "JP",          // 1
+        "CALL",        // 2
+        "SE imm",      // 3
+        "SNE imm",     // 4
+        "SE reg",      // 5
+        "LD imm",      // 6
+        "ADD imm",     // 7
+        "ALU",         // 8
+        "SNE reg",     // 9
+        "LD I",        // A
+        "JP V0",       // B
+        "RND",         // C
+        "DRW",         // D
+        "SKP/SKNP",    // E
+        "Fx misc"      // F
+    };
+
+    const char *ExecutionProfile::ClassName(size_t opcodeClass)
+    {
+        return opcodeClass < OPCODE_CLASS_COUNT ? OPCODE_CLASS_NAMES[opcodeClass] : "?";
+    }
+
+    uint64_t ExecutionProfile::GetTotalCount() const
+    {
+        uint64_t total = 0;
+        for (const auto count : ClassCounts)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    void ExecutionProfile::WriteCSV(std::ostream &os) const
+    {
+        os << "kind,id,name,count,total_ns\n";
+        for (size_t opcodeClass = 0; opcodeClass < OPCODE_CLASS_COUNT; ++opcodeClass)
+        {
+            os << "class," << std::hex << std::uppercase << opcodeClass << std::dec << ","
+               << ClassName(opcodeClass) << "," << ClassCounts[opcodeClass] << ","
+               << ClassNanoseconds[opcodeClass] << "\n";
+        }
+
+        // time isn't measured per address, that would double the overhead
+        for (size_t pc = 0; pc < PCCounts.size(); ++pc)
+        {
+            if (PCCounts[pc] > 0)
+            {
+                os << "pc," << std::hex << std::uppercase << std::setw(3) << std::setfill('0') << pc
+                   << std::dec << std::setfill(' ') << ",," << PCCounts[pc] << ",\n";
+            }
+        }
+    }
+}
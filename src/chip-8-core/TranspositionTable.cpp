@@ -0,0 +1,107 @@
+#include "TranspositionTable.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace SKChip8
+{
+    TranspositionTable::TranspositionTable(uint8_t capacityLog2)
+    {
+        if (capacityLog2 >= 48)
+        {
+            throw std::invalid_argument("Transposition table capacity is too large");
+        }
+
+        mask_ = (size_t(1) << capacityLog2) - 1;
+        slots_ = std::make_unique<Slot[]>(mask_ + 1);
+        Clear();
+    }
+
+    void TranspositionTable::Clear()
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+        {
+            slots_[i].key.store(0, std::memory_order_relaxed);
+            slots_[i].check.store(0, std::memory_order_relaxed);
+            slots_[i].value.store(EMPTY_VALUE, std::memory_order_relaxed);
+        }
+        size_.store(0, std::memory_order_release);
+    }
+
+    uint64_t TranspositionTable::waitForValue(const Slot &slot)
+    {
+        auto value = slot.value.load(std::memory_order_acquire);
+        while (value == EMPTY_VALUE)
+        {
+            std::this_thread::yield();
+            value = slot.value.load(std::memory_order_acquire);
+        }
+        return value;
+    }
+
+    std::pair<uint64_t, bool> TranspositionTable::FindOrInsert(const Hash128 &hash, uint64_t value)
+    {
+        if (value == EMPTY_VALUE)
+        {
+            throw std::invalid_argument("Cannot store the reserved empty value");
+        }
+
+        const auto key = slotKey(hash);
+        for (size_t probe = 0; probe <= mask_; ++probe)
+        {
+            auto &slot = slots_[(key + probe) & mask_];
+            auto existing = slot.key.load(std::memory_order_acquire);
+
+            if (existing == 0)
+            {
+                if (slot.key.compare_exchange_strong(existing, key, std::memory_order_acq_rel))
+                {
+                    // we own the slot, publish the rest of the entry
+                    slot.check.store(hash.High, std::memory_order_relaxed);
+                    slot.value.store(value, std::memory_order_release);
+                    size_.fetch_add(1, std::memory_order_relaxed);
+                    return {value, true};
+                }
+                // lost the race, existing now holds the winner's key
+            }
+
+            if (existing == key)
+            {
+                auto stored = waitForValue(slot);
+                if (slot.check.load(std::memory_order_relaxed) == hash.High)
+                {
+                    return {stored, false};
+                }
+            }
+        }
+
+        throw std::runtime_error("Transposition table is full");
+    }
+
+    bool TranspositionTable::Probe(const Hash128 &hash, uint64_t &value) const
+    {
+        const auto key = slotKey(hash);
+        for (size_t probe = 0; probe <= mask_; ++probe)
+        {
+            const auto &slot = slots_[(key + probe) & mask_];
+            auto existing = slot.key.load(std::memory_order_acquire);
+
+            if (existing == 0)
+            {
+                return false;
+            }
+
+            if (existing == key)
+            {
+                auto stored = waitForValue(slot);
+                if (slot.check.load(std::memory_order_relaxed) == hash.High)
+                {
+                    value = stored;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+}
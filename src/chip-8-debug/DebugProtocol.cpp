@@ -0,0 +1,62 @@
+#include "DebugProtocol.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <stdexcept>
+
+namespace SKChip8
+{
+    void AppendDebugRequest(std::vector<uint8_t> &out, DebugCommand command, const uint8_t *payload, size_t size)
+    {
+        uint8_t header[DEBUG_REQUEST_HEADER_SIZE];
+        header[0] = static_cast<uint8_t>(command);
+        StoreLE(header + 1, size, 4);
+        out.insert(out.end(), header, header + sizeof(header));
+        out.insert(out.end(), payload, payload + size);
+    }
+
+    void AppendDebugResponse(std::vector<uint8_t> &out, DebugCommand command, DebugStatus status, const uint8_t *payload, size_t size)
+    {
+        uint8_t header[DEBUG_RESPONSE_HEADER_SIZE];
+        header[0] = static_cast<uint8_t>(command);
+        header[1] = static_cast<uint8_t>(status);
+        StoreLE(header + 2, size, 4);
+        out.insert(out.end(), header, header + sizeof(header));
+        out.insert(out.end(), payload, payload + size);
+    }
+
+    static bool parseMessage(const uint8_t *data, size_t size, size_t headerSize, DebugMessage &out)
+    {
+        if (size < headerSize)
+        {
+            return false;
+        }
+
+        const auto payloadSize = static_cast<uint32_t>(LoadLE(data + headerSize - 4, 4));
+        if (payloadSize > DEBUG_MAX_PAYLOAD)
+        {
+            throw std::runtime_error("Debug message payload too large: " + std::to_string(payloadSize));
+        }
+        if (size < headerSize + payloadSize)
+        {
+            return false;
+        }
+
+        out.Command = static_cast<DebugCommand>(data[0]);
+        out.Status = headerSize == DEBUG_RESPONSE_HEADER_SIZE ? static_cast<DebugStatus>(data[1]) : DebugStatus::Ok;
+        out.Payload = data + headerSize;
+        out.PayloadSize = payloadSize;
+        out.Size = headerSize + payloadSize;
+        return true;
+    }
+
+    bool ParseDebugRequest(const uint8_t *data, size_t size, DebugMessage &out)
+    {
+        return parseMessage(data, size, DEBUG_REQUEST_HEADER_SIZE, out);
+    }
+
+    bool ParseDebugResponse(const uint8_t *data, size_t size, DebugMessage &out)
+    {
+        return parseMessage(data, size, DEBUG_RESPONSE_HEADER_SIZE, out);
+    }
+}
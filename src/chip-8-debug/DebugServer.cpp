@@ -0,0 +1,401 @@
+#include "DebugServer.h"
+
+#include <Emulator/Emulator.h>
+#include <Utils/ByteOrder.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace
+{
+    void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    sockaddr_un unixAddress(const std::string &path)
+    {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            throw std::invalid_argument("Socket path is too long: " + path);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, path.c_str());
+        return addr;
+    }
+
+    [[noreturn]] void throwSocketError(const std::string &what, int fd)
+    {
+        const std::string reason = std::strerror(errno);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error(what + ": " + reason);
+    }
+
+    void expectPayload(size_t size, size_t expected, const char *command)
+    {
+        if (size != expected)
+        {
+            throw std::invalid_argument(std::string(command) + " expects " + std::to_string(expected) +
+                                        " payload bytes, got " + std::to_string(size));
+        }
+    }
+}
+
+namespace SKChip8
+{
+    DebugServer::DebugServer(const std::string &unixPath, DebugTarget &target)
+        : unixPath_(unixPath), target_(target)
+    {
+        listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        auto addr = unixAddress(unixPath);
+        unlink(unixPath.c_str());
+        if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listenFd_, 16) < 0)
+        {
+            throwSocketError("Could not listen on " + unixPath, listenFd_);
+        }
+        setNonBlocking(listenFd_);
+    }
+
+    DebugServer::~DebugServer()
+    {
+        for (auto &client : clients_)
+        {
+            close(client.Fd);
+        }
+        close(listenFd_);
+        unlink(unixPath_.c_str());
+    }
+
+    void DebugServer::Pump(int timeoutMs)
+    {
+        if (timeoutMs != 0)
+        {
+            std::vector<pollfd> fds;
+            fds.push_back(pollfd{listenFd_, POLLIN, 0});
+            for (const auto &client : clients_)
+            {
+                const short events = POLLIN | (client.Offset < client.Output.size() ? POLLOUT : 0);
+                fds.push_back(pollfd{client.Fd, events, 0});
+            }
+            poll(fds.data(), fds.size(), timeoutMs);
+        }
+
+        acceptClients();
+
+        for (size_t i = 0; i < clients_.size();)
+        {
+            if (receive(clients_[i]) && flush(clients_[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            close(clients_[i].Fd);
+            clients_[i] = std::move(clients_.back());
+            clients_.pop_back();
+        }
+    }
+
+    void DebugServer::acceptClients()
+    {
+        while (true)
+        {
+            const int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0)
+            {
+                return;
+            }
+
+            setNonBlocking(fd);
+            clients_.push_back(Client{fd, {}, {}, 0});
+        }
+    }
+
+    bool DebugServer::receive(Client &client)
+    {
+        uint8_t buffer[16 << 10];
+        while (true)
+        {
+            const auto received = recv(client.Fd, buffer, sizeof(buffer), 0);
+            if (received == 0)
+            {
+                return false;
+            }
+            if (received < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    return false;
+                }
+                break;
+            }
+            client.Input.insert(client.Input.end(), buffer, buffer + received);
+        }
+
+        // answer everything that has arrived, a pipelining client may have
+        // sent hundreds of requests in one write
+        size_t consumed = 0;
+        DebugMessage request;
+        try
+        {
+            while (ParseDebugRequest(client.Input.data() + consumed, client.Input.size() - consumed, request))
+            {
+                std::vector<uint8_t> response;
+                try
+                {
+                    execute(request.Command, request.Payload, request.PayloadSize, response);
+                    AppendDebugResponse(client.Output, request.Command, DebugStatus::Ok, response.data(), response.size());
+                }
+                catch (const std::exception &e)
+                {
+                    const auto message = std::string(e.what());
+                    AppendDebugResponse(client.Output, request.Command, DebugStatus::Error,
+                                        reinterpret_cast<const uint8_t *>(message.data()), message.size());
+                }
+                consumed += request.Size;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            // oversized request, the stream can't be resynchronized
+            return false;
+        }
+
+        client.Input.erase(client.Input.begin(), client.Input.begin() + consumed);
+        return true;
+    }
+
+    bool DebugServer::flush(Client &client)
+    {
+        while (client.Offset < client.Output.size())
+        {
+            const auto sent = send(client.Fd, client.Output.data() + client.Offset, client.Output.size() - client.Offset, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            client.Offset += sent;
+        }
+
+        client.Output.clear();
+        client.Offset = 0;
+        return true;
+    }
+
+    void DebugServer::execute(DebugCommand command, const uint8_t *payload, size_t size, std::vector<uint8_t> &response)
+    {
+        const auto &emulator = target_.GetEmulator();
+        const auto &cpu = emulator.GetCPU();
+        auto &breakpoints = target_.GetBreakpoints();
+
+        switch (command)
+        {
+        case DebugCommand::Hello:
+        {
+            response.assign(DEBUG_PROTOCOL_MAGIC, DEBUG_PROTOCOL_MAGIC + sizeof(DEBUG_PROTOCOL_MAGIC));
+            response.resize(response.size() + 2);
+            StoreLE(response.data() + sizeof(DEBUG_PROTOCOL_MAGIC), DEBUG_PROTOCOL_VERSION, 2);
+            break;
+        }
+        case DebugCommand::LoadROM:
+            target_.LoadProgram(std::string(payload, payload + size));
+            break;
+        case DebugCommand::Reset:
+            target_.Reset();
+            break;
+        case DebugCommand::Run:
+        {
+            expectPayload(size, 8, "Run");
+            const auto count = LoadLE(payload, 8);
+            const auto executed = target_.Run(count);
+            response.resize(9);
+            StoreLE(response.data(), executed, 8);
+            response[8] = executed < count ? 1 : 0;
+            break;
+        }
+        case DebugCommand::Step:
+            expectPayload(size, 8, "Step");
+            target_.Step(LoadLE(payload, 8));
+            break;
+        case DebugCommand::AddBreakpoint:
+        {
+            if (size < 2)
+            {
+                throw std::invalid_argument("AddBreakpoint expects an address");
+            }
+            const auto address = static_cast<uint16_t>(LoadLE(payload, 2));
+            if (size == 2)
+            {
+                breakpoints.Add(address);
+            }
+            else
+            {
+                breakpoints.Add(address, BreakCondition::Parse(std::string(payload + 2, payload + size)));
+            }
+            break;
+        }
+        case DebugCommand::RemoveBreakpoint:
+            expectPayload(size, 2, "RemoveBreakpoint");
+            breakpoints.Remove(static_cast<uint16_t>(LoadLE(payload, 2)));
+            break;
+        case DebugCommand::AddWatchpoint:
+            expectPayload(size, 6, "AddWatchpoint");
+            breakpoints.AddWatch(static_cast<uint16_t>(LoadLE(payload, 2)), static_cast<uint16_t>(LoadLE(payload + 2, 2)),
+                                  payload[4] != 0, payload[5] != 0);
+            break;
+        case DebugCommand::ClearBreakpoints:
+            breakpoints.Clear();
+            break;
+        case DebugCommand::ReadMemory:
+        {
+            expectPayload(size, 4, "ReadMemory");
+            const auto address = LoadLE(payload, 2);
+            const auto length = LoadLE(payload + 2, 2);
+            if (address + length > CHIP8_MEM_SIZE)
+            {
+                throw std::out_of_range("ReadMemory past the end of memory");
+            }
+            const auto &memory = cpu.GetMemory();
+            response.assign(memory.begin() + address, memory.begin() + address + length);
+            break;
+        }
+        case DebugCommand::ReadRegisters:
+        {
+            response.resize(DEBUG_REGISTERS_SIZE);
+            auto cursor = response.data();
+            StoreLE(cursor, cpu.GetPC(), 2);
+            StoreLE(cursor + 2, cpu.GetIndexPointer(), 2);
+            cursor += 4;
+            const auto &registers = cpu.GetRegisters();
+            std::copy(registers.begin(), registers.end(), cursor);
+            cursor += registers.size();
+            *cursor++ = cpu.GetDelayTimer();
+            *cursor++ = cpu.GetSoundTimer();
+            StoreLE(cursor, cpu.GetCycleCount(), 8);
+            break;
+        }
+        case DebugCommand::ReadFrame:
+        {
+            const auto &frame = cpu.GetPackedFrameBuffer();
+            response.assign(frame.begin(), frame.end());
+            break;
+        }
+        case DebugCommand::SaveState:
+        {
+            const auto state = emulator.SaveState();
+            response.assign(state.begin(), state.end());
+            break;
+        }
+        case DebugCommand::LoadState:
+            target_.LoadState(payload, size);
+            break;
+        case DebugCommand::SetKeys:
+            expectPayload(size, 2, "SetKeys");
+            target_.SetKeyMask(static_cast<uint16_t>(LoadLE(payload, 2)));
+            break;
+        default:
+            throw std::invalid_argument("Unknown debug command " + std::to_string(static_cast<int>(command)));
+        }
+    }
+
+    DebugClient::DebugClient(const std::string &unixPath) : pending_(0)
+    {
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0)
+        {
+            throwSocketError("Could not create socket", -1);
+        }
+
+        auto addr = unixAddress(unixPath);
+        if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            throwSocketError("Could not connect to " + unixPath, fd_);
+        }
+    }
+
+    DebugClient::~DebugClient()
+    {
+        close(fd_);
+    }
+
+    void DebugClient::Send(DebugCommand command, const std::vector<uint8_t> &payload)
+    {
+        AppendDebugRequest(output_, command, payload.data(), payload.size());
+        pending_++;
+    }
+
+    std::vector<DebugClient::Response> DebugClient::Flush()
+    {
+        // send everything before reading anything, the server answers as
+        // requests arrive so both directions make progress
+        size_t sent = 0;
+        while (sent < output_.size())
+        {
+            const auto result = send(fd_, output_.data() + sent, output_.size() - sent, MSG_NOSIGNAL);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throwSocketError("Could not send debug requests", -1);
+            }
+            sent += result;
+        }
+        output_.clear();
+
+        std::vector<Response> responses;
+        responses.reserve(pending_);
+        size_t consumed = 0;
+        while (responses.size() < pending_)
+        {
+            DebugMessage message;
+            if (ParseDebugResponse(input_.data() + consumed, input_.size() - consumed, message))
+            {
+                responses.push_back(Response{message.Command, message.Status,
+                                             std::vector<uint8_t>(message.Payload, message.Payload + message.PayloadSize)});
+                consumed += message.Size;
+                continue;
+            }
+
+            uint8_t buffer[16 << 10];
+            const auto received = recv(fd_, buffer, sizeof(buffer), 0);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                throw std::runtime_error("Debug server closed the connection");
+            }
+            input_.insert(input_.end(), buffer, buffer + received);
+        }
+
+        input_.erase(input_.begin(), input_.begin() + consumed);
+        pending_ = 0;
+        return responses;
+    }
+}
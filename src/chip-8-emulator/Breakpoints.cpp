@@ -0,0 +1,273 @@
+#include "Breakpoints.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    static constexpr const char *COMPARISON_TOKENS[] = {"==", "!=", "<", "<=", ">", ">="};
+
+    bool BreakCondition::Evaluate(const CPU &cpu) const
+    {
+        uint16_t left = 0;
+        switch (Left)
+        {
+        case Operand::Register:
+            left = cpu.GetRegisters()[Register];
+            break;
+        case Operand::Index:
+            left = cpu.GetIndexPointer();
+            break;
+        case Operand::DelayTimer:
+            left = cpu.GetDelayTimer();
+            break;
+        case Operand::SoundTimer:
+            left = cpu.GetSoundTimer();
+            break;
+        }
+
+        switch (Compare)
+        {
+        case Comparison::Equal:
+            return left == Value;
+        case Comparison::NotEqual:
+            return left != Value;
+        case Comparison::Less:
+            return left < Value;
+        case Comparison::LessEqual:
+            return left <= Value;
+        case Comparison::Greater:
+            return left > Value;
+        case Comparison::GreaterEqual:
+            return left >= Value;
+        }
+        return false;
+    }
+
+    BreakCondition BreakCondition::Parse(const std::string &text)
+    {
+        std::istringstream ss(text);
+        std::string operand, comparison, value;
+        if (!(ss >> operand >> comparison >> value) || !(ss >> std::ws).eof())
+        {
+            throw std::invalid_argument("expected \"<operand> <comparison> <value>\": " + text);
+        }
+
+        BreakCondition condition{};
+        std::transform(operand.begin(), operand.end(), operand.begin(), ::toupper);
+        if (operand.size() == 2 && operand[0] == 'V' && std::isxdigit(static_cast<unsigned char>(operand[1])))
+        {
+            condition.Left = Operand::Register;
+            condition.Register = static_cast<uint8_t>(std::stoi(operand.substr(1), nullptr, 16));
+        }
+        else if (operand == "I")
+        {
+            condition.Left = Operand::Index;
+        }
+        else if (operand == "DT")
+        {
+            condition.Left = Operand::DelayTimer;
+        }
+        else if (operand == "ST")
+        {
+            condition.Left = Operand::SoundTimer;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown operand " + operand + ", expected V0-VF, I, DT or ST");
+        }
+
+        const auto token = std::find(std::begin(COMPARISON_TOKENS), std::end(COMPARISON_TOKENS), comparison);
+        if (token == std::end(COMPARISON_TOKENS))
+        {
+            throw std::invalid_argument("unknown comparison " + comparison);
+        }
+        condition.Compare = static_cast<Comparison>(token - std::begin(COMPARISON_TOKENS));
+
+        size_t parsed = 0;
+        unsigned long number = 0;
+        try
+        {
+            number = std::stoul(value, &parsed, 16);
+        }
+        catch (const std::exception &)
+        {
+            parsed = 0;
+        }
+        if (parsed != value.size() || number > 0xFFFF)
+        {
+            throw std::invalid_argument("expected a 16 bit hex value: " + value);
+        }
+        condition.Value = static_cast<uint16_t>(number);
+
+        return condition;
+    }
+
+    std::string BreakCondition::ToString() const
+    {
+        std::ostringstream ss;
+        switch (Left)
+        {
+        case Operand::Register:
+            ss << "V" << std::hex << std::uppercase << static_cast<int>(Register);
+            break;
+        case Operand::Index:
+            ss << "I";
+            break;
+        case Operand::DelayTimer:
+            ss << "DT";
+            break;
+        case Operand::SoundTimer:
+            ss << "ST";
+            break;
+        }
+        ss << " " << COMPARISON_TOKENS[static_cast<size_t>(Compare)] << " "
+           << std::hex << std::uppercase << Value;
+        return ss.str();
+    }
+
+    void BreakpointSet::Add(uint16_t address)
+    {
+        address %= CHIP8_MEM_SIZE;
+        breakpoints_.push_back(Breakpoint{address, false, BreakCondition{}});
+        bits_[address / 64] |= uint64_t(1) << (address % 64);
+    }
+
+    void BreakpointSet::Add(uint16_t address, const BreakCondition &condition)
+    {
+        address %= CHIP8_MEM_SIZE;
+        breakpoints_.push_back(Breakpoint{address, true, condition});
+        bits_[address / 64] |= uint64_t(1) << (address % 64);
+    }
+
+    void BreakpointSet::Remove(uint16_t address)
+    {
+        address %= CHIP8_MEM_SIZE;
+        breakpoints_.erase(std::remove_if(breakpoints_.begin(), breakpoints_.end(),
+                                          [address](const Breakpoint &breakpoint)
+                                          { return breakpoint.Address == address; }),
+                           breakpoints_.end());
+        bits_[address / 64] &= ~(uint64_t(1) << (address % 64));
+    }
+
+    void BreakpointSet::RemoveAt(size_t index)
+    {
+        if (index >= breakpoints_.size())
+        {
+            throw std::out_of_range("no breakpoint " + std::to_string(index));
+        }
+
+        const auto address = breakpoints_[index].Address;
+        breakpoints_.erase(breakpoints_.begin() + index);
+
+        // the bit stays while another breakpoint shares the address
+        const bool shared = std::any_of(breakpoints_.begin(), breakpoints_.end(),
+                                        [address](const Breakpoint &breakpoint)
+                                        { return breakpoint.Address == address; });
+        if (!shared)
+        {
+            bits_[address / 64] &= ~(uint64_t(1) << (address % 64));
+        }
+    }
+
+    void BreakpointSet::AddWatch(uint16_t address, uint16_t size, bool read, bool write)
+    {
+        if (size == 0 || address + size > CHIP8_MEM_SIZE)
+        {
+            throw std::invalid_argument("watchpoint range must be non-empty and inside memory");
+        }
+        if (!read && !write)
+        {
+            throw std::invalid_argument("watchpoint must watch reads, writes or both");
+        }
+
+        watchpoints_.push_back(Watchpoint{address, size, read, write});
+        rebuildWatchBits();
+    }
+
+    void BreakpointSet::RemoveWatchAt(size_t index)
+    {
+        if (index >= watchpoints_.size())
+        {
+            throw std::out_of_range("no watchpoint " + std::to_string(index));
+        }
+
+        watchpoints_.erase(watchpoints_.begin() + index);
+        rebuildWatchBits();
+    }
+
+    void BreakpointSet::Clear()
+    {
+        breakpoints_.clear();
+        bits_.fill(0);
+        watchpoints_.clear();
+        watchBits_.fill(0);
+    }
+
+    const Watchpoint *BreakpointSet::FindWatchHit(const CPU &cpu, MemoryAccess *access) const
+    {
+        std::array<MemoryAccess, MAX_MEMORY_ACCESSES> accesses;
+        const auto count = cpu.PendingMemoryAccesses(accesses);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto &pending = accesses[i];
+            const uint8_t kind = pending.Write ? WATCH_WRITE : WATCH_READ;
+
+            // the flags rule out almost every access, the list is only
+            // searched to say which watchpoint it was
+            for (size_t offset = 0; offset < pending.Size; ++offset)
+            {
+                const auto address = (pending.Address + offset) % CHIP8_MEM_SIZE;
+                if (!(watchBits_[address] & kind))
+                {
+                    continue;
+                }
+
+                for (const auto &watchpoint : watchpoints_)
+                {
+                    if ((pending.Write ? watchpoint.Write : watchpoint.Read) &&
+                        address >= watchpoint.Address && address < watchpoint.Address + watchpoint.Size)
+                    {
+                        if (access)
+                        {
+                            *access = pending;
+                        }
+                        return &watchpoint;
+                    }
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void BreakpointSet::rebuildWatchBits()
+    {
+        watchBits_.fill(0);
+        for (const auto &watchpoint : watchpoints_)
+        {
+            const uint8_t kind = (watchpoint.Read ? WATCH_READ : 0) | (watchpoint.Write ? WATCH_WRITE : 0);
+            for (size_t offset = 0; offset < watchpoint.Size; ++offset)
+            {
+                watchBits_[watchpoint.Address + offset] |= kind;
+            }
+        }
+    }
+
+    bool BreakpointSet::checkConditions(const CPU &cpu) const
+    {
+        // only reached for an address with a breakpoint, of which there are few
+        for (const auto &breakpoint : breakpoints_)
+        {
+            if (breakpoint.Address == cpu.GetPC() &&
+                (!breakpoint.Conditional || breakpoint.Condition.Evaluate(cpu)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,120 @@
+#include "Disassembly.h"
+
+#include <Utils/CHIP8ISA.h>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace SKChip8
+{
+    DisassemblyCache::DisassemblyCache() : memory_{}, lines_{}, valid_(false)
+    {
+    }
+
+    size_t DisassemblyCache::Update(const std::array<uint8_t, CHIP8_MEM_SIZE> &memory)
+    {
+        size_t formatted = 0;
+
+        if (!valid_)
+        {
+            memory_ = memory;
+            for (size_t address = 0; address < CHIP8_MEM_SIZE; ++address)
+            {
+                formatLine(static_cast<uint16_t>(address));
+            }
+            valid_ = true;
+            return CHIP8_MEM_SIZE;
+        }
+
+        // memory is usually unchanged between frames, and memcmp is much
+        // faster than the word loop below at finding that out
+        if (std::memcmp(memory_.data(), memory.data(), CHIP8_MEM_SIZE) == 0)
+        {
+            return 0;
+        }
+
+        for (size_t block = 0; block < CHIP8_MEM_SIZE; block += sizeof(uint64_t))
+        {
+            uint64_t before;
+            uint64_t after;
+            std::memcpy(&before, memory_.data() + block, sizeof(uint64_t));
+            std::memcpy(&after, memory.data() + block, sizeof(uint64_t));
+            if (before == after)
+            {
+                continue;
+            }
+
+            std::memcpy(memory_.data() + block, &after, sizeof(uint64_t));
+
+            // a changed byte is the low half of the line before it. the line
+            // before the block is redone even if it was already this update,
+            // which is cheaper than tracking it
+            size_t next = 0;
+            for (size_t address = block; address < block + sizeof(uint64_t); ++address)
+            {
+                if (reinterpret_cast<const uint8_t *>(&before)[address - block] == memory[address])
+                {
+                    continue;
+                }
+
+                for (size_t line = address == 0 ? 0 : address - 1; line <= address; ++line)
+                {
+                    if (line >= next)
+                    {
+                        formatLine(static_cast<uint16_t>(line));
+                        next = line + 1;
+                        ++formatted;
+                    }
+                }
+            }
+        }
+
+        return formatted;
+    }
+
+    void DisassemblyCache::formatLine(uint16_t address)
+    {
+        auto &line = lines_[address];
+        const uint8_t low = address + 1 < CHIP8_MEM_SIZE ? memory_[address + 1] : 0;
+        line.Opcode = static_cast<uint16_t>(memory_[address] << 8 | low);
+
+        std::stringstream text;
+        try
+        {
+            DecodeInstruction(line.Opcode)->dump(text);
+            line.Valid = true;
+        }
+        catch (const std::exception &)
+        {
+            text.str("");
+            text << "DW\t0x" << std::hex << std::setfill('0') << std::setw(4) << line.Opcode;
+            line.Valid = false;
+        }
+
+        // dump separates operands with tabs, which ImGui does not expand.
+        // expand them to 8 column stops here so columns line up in a fixed
+        // width font
+        const auto raw = text.str();
+        size_t length = 0;
+        for (const char c : raw)
+        {
+            if (length + 1 >= TEXT_SIZE)
+            {
+                break;
+            }
+
+            if (c != '\t')
+            {
+                line.Text[length++] = c;
+                continue;
+            }
+
+            do
+            {
+                line.Text[length++] = ' ';
+            } while (length % 8 != 0 && length + 1 < TEXT_SIZE);
+        }
+        line.Text[length] = '\0';
+    }
+}
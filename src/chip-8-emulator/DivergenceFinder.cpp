@@ -0,0 +1,118 @@
+#include "DivergenceFinder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace SKChip8
+{
+    ExecutionEngine ReferenceEngine()
+    {
+        return ExecutionEngine{"step", [](Emulator &emulator, uint64_t count)
+                               {
+                                   for (uint64_t i = 0; i < count; ++i)
+                                   {
+                                       emulator.Step();
+                                   }
+                               }};
+    }
+
+    ExecutionEngine BatchedEngine()
+    {
+        return ExecutionEngine{"run", [](Emulator &emulator, uint64_t count)
+                               { emulator.Run(count); }};
+    }
+
+    DivergenceFinder::DivergenceFinder(ExecutionEngine a, ExecutionEngine b, uint64_t checkInterval)
+        : engineA_(std::move(a)),
+          engineB_(std::move(b)),
+          checkInterval_(checkInterval)
+    {
+        if (checkInterval_ == 0)
+        {
+            throw std::invalid_argument("Check interval must be positive");
+        }
+    }
+
+    bool DivergenceFinder::matches(const Emulator &a, const Emulator &b)
+    {
+        return a.GetCycleCount() == b.GetCycleCount() && a.StateHash() == b.StateHash();
+    }
+
+    DivergenceReport DivergenceFinder::Run(const Movie &movie, Emulator &a, Emulator &b)
+    {
+        MoviePlayer playerA(movie);
+        MoviePlayer playerB(movie);
+        playerA.Begin(a);
+        playerB.Begin(b);
+
+        DivergenceReport report;
+        report.Diverged = false;
+
+        // the engines agree up to here
+        uint64_t good = 0;
+        Emulator::SaveStateBuffer goodA = a.SaveState();
+        Emulator::SaveStateBuffer goodB = b.SaveState();
+
+        uint64_t bad = 0;
+        while (good < movie.Length)
+        {
+            const auto next = std::min(good + checkInterval_, movie.Length);
+            playerA.RunTo(a, next, engineA_.Run);
+            playerB.RunTo(b, next, engineB_.Run);
+            if (!matches(a, b))
+            {
+                bad = next;
+                break;
+            }
+
+            good = next;
+            a.SaveState(goodA);
+            b.SaveState(goodB);
+        }
+
+        if (bad == 0)
+        {
+            report.MatchingCycles = good;
+            return report;
+        }
+
+        // bisect between the matching snapshot and the mismatch, always
+        // restarting from the snapshot so each probe is a plain forward run
+        while (bad - good > 1)
+        {
+            const auto middle = good + (bad - good) / 2;
+            a.LoadState(goodA);
+            b.LoadState(goodB);
+            playerA.Resync(a);
+            playerB.Resync(b);
+            playerA.RunTo(a, middle, engineA_.Run);
+            playerB.RunTo(b, middle, engineB_.Run);
+
+            if (matches(a, b))
+            {
+                good = middle;
+                a.SaveState(goodA);
+                b.SaveState(goodB);
+            }
+            else
+            {
+                bad = middle;
+            }
+        }
+
+        report.Diverged = true;
+        report.MatchingCycles = good;
+        report.Before = goodA;
+
+        a.LoadState(goodA);
+        b.LoadState(goodB);
+        playerA.Resync(a);
+        playerB.Resync(b);
+        playerA.RunTo(a, bad, engineA_.Run);
+        playerB.RunTo(b, bad, engineB_.Run);
+        a.SaveState(report.AfterA);
+        b.SaveState(report.AfterB);
+        return report;
+    }
+}
@@ -1,40 +1,215 @@
 #include "Emulator.h"
 
+#include <Utils/ByteOrder.h>
+
+#include <cstring>
+#include <stdexcept>
+
 namespace SKChip8
 {
     void Emulator::Step()
     {
-        chip8CPU_->Cycle();
+        chip8CPU_.Cycle();
         instructionsSinceLastTick_++;
         if (instructionsSinceLastTick_ >= instructionsPerTick_)
         {
             instructionsSinceLastTick_ = 0;
-            chip8CPU_->TimerTick();
+            chip8CPU_.TimerTick();
+        }
+    }
+
+    void Emulator::StepJournaled(UndoJournal &journal)
+    {
+        auto &record = journal.BeginRecord();
+        uint8_t timerPhase[8];
+        StoreLE(timerPhase, instructionsSinceLastTick_, 8);
+        record.insert(record.end(), timerPhase, timerPhase + sizeof(timerPhase));
+        chip8CPU_.RecordUndo(record);
+        journal.CommitRecord();
+
+        Step();
+    }
+
+    bool Emulator::StepBack(UndoJournal &journal)
+    {
+        const auto record = journal.PopRecord();
+        if (!record)
+        {
+            return false;
+        }
+        if (record->size() < 8)
+        {
+            throw std::runtime_error("Undo record is truncated");
+        }
+
+        chip8CPU_.ApplyUndo(record->data() + 8, record->size() - 8);
+        instructionsSinceLastTick_ = LoadLE(record->data(), 8);
+        return true;
+    }
+
+    void Emulator::Run(uint64_t count)
+    {
+        // same as Step() but runs whole stretches between timer ticks
+        // without rechecking the tick counter on every instruction
+        while (count > 0)
+        {
+            const auto untilTick = instructionsPerTick_ - instructionsSinceLastTick_;
+            const auto batch = count < untilTick ? count : untilTick;
+            for (uint64_t i = 0; i < batch; ++i)
+            {
+                chip8CPU_.Cycle();
+            }
+
+            count -= batch;
+            instructionsSinceLastTick_ += batch;
+            if (instructionsSinceLastTick_ >= instructionsPerTick_)
+            {
+                instructionsSinceLastTick_ = 0;
+                chip8CPU_.TimerTick();
+            }
         }
     }
 
+    uint64_t Emulator::RunUntilBreak(uint64_t count, const BreakpointSet &breakpoints)
+    {
+        if (breakpoints.Empty())
+        {
+            Run(count);
+            return count;
+        }
+
+        return breakpoints.RunUntilBreak(chip8CPU_, count, [this]
+                                         { Step(); });
+    }
+
     void Emulator::Reset()
     {
-        chip8CPU_ = std::make_shared<CPU>();
+        chip8CPU_ = CPU();
         instructionsSinceLastTick_ = 0;
         reloadROM();
     }
 
     void Emulator::reloadROM()
     {
-        chip8CPU_->LoadROM(ROM_.getROM());
+        if (ROM_)
+        {
+            chip8CPU_.LoadROM(ROM_->getROM());
+        }
     }
 
     void Emulator::LoadProgram(const std::string &rompath)
     {
-        ROM_ = ROMLoader(rompath);
-
-        reloadROM();
+        // LoadROM throws on an oversized ROM before touching memory, keep
+        // the previous ROM in that case so Reset still works
+        auto rom = std::make_shared<const ROMLoader>(rompath);
+        chip8CPU_.LoadROM(rom->getROM());
+        ROM_ = std::move(rom);
     }
 
     void Emulator::SetKeyState(uint8_t key, bool state)
     {
-        chip8CPU_->SetKeyState(key, state);
+        chip8CPU_.SetKeyState(key, state);
     }
 
+    void Emulator::SeedRandom(uint32_t seed)
+    {
+        chip8CPU_.SeedRandom(seed);
+    }
+
+    void Emulator::SetKeyMask(uint16_t mask)
+    {
+        for (uint8_t key = 0; key < KEY_COUNT; ++key)
+        {
+            chip8CPU_.SetKeyState(key, (mask >> key) & 1);
+        }
+    }
+
+    uint16_t Emulator::GetKeyMask() const
+    {
+        const auto keys = chip8CPU_.GetKeyState();
+        uint16_t mask = 0;
+        for (uint8_t key = 0; key < KEY_COUNT; ++key)
+        {
+            mask |= keys[key] ? (1 << key) : 0;
+        }
+        return mask;
+    }
+
+    std::unique_ptr<Emulator> Emulator::Clone() const
+    {
+        return std::make_unique<Emulator>(*this);
+    }
+
+    void Emulator::CloneInto(Emulator &target) const
+    {
+        // only copies the Emulator part if target is an adapter
+        target = *this;
+    }
+
+    void Emulator::SaveState(SaveStateBuffer &out) const
+    {
+        auto cursor = out.data();
+        std::memcpy(cursor, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC));
+        StoreLE(cursor + 4, SAVE_STATE_VERSION, 2);
+        StoreLE(cursor + 6, 0, 2);
+        cursor += SAVE_STATE_HEADER_SIZE;
+
+        chip8CPU_.SaveState(cursor);
+        cursor += CPU::STATE_SIZE;
+
+        StoreLE(cursor, instructionsPerTick_, 8);
+        StoreLE(cursor + 8, instructionsSinceLastTick_, 8);
+    }
+
+    Emulator::SaveStateBuffer Emulator::SaveState() const
+    {
+        SaveStateBuffer state;
+        SaveState(state);
+        return state;
+    }
+
+    void Emulator::LoadState(const uint8_t *data, size_t size)
+    {
+        if (size != SAVE_STATE_SIZE || std::memcmp(data, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a save state");
+        }
+
+        const auto version = LoadLE(data + 4, 2);
+        if (version != SAVE_STATE_VERSION)
+        {
+            throw std::runtime_error("Unsupported save state version: " + std::to_string(version));
+        }
+
+        const auto cpuState = data + SAVE_STATE_HEADER_SIZE;
+        const auto timing = cpuState + CPU::STATE_SIZE;
+        const auto instructionsPerTick = LoadLE(timing, 8);
+        const auto instructionsSinceLastTick = LoadLE(timing + 8, 8);
+        if (instructionsPerTick == 0 || instructionsSinceLastTick >= instructionsPerTick)
+        {
+            throw std::runtime_error("Corrupt save state timing");
+        }
+
+        chip8CPU_.LoadState(cpuState);
+        instructionsPerTick_ = instructionsPerTick;
+        instructionsSinceLastTick_ = instructionsSinceLastTick;
+    }
+
+    Hash128 Emulator::GetROMHash() const
+    {
+        if (!ROM_)
+        {
+            return Hash128{0, 0};
+        }
+
+        const auto &rom = ROM_->getROM();
+        return HashBytes128(rom.data(), rom.size());
+    }
+
+    Hash128 Emulator::StateHash() const
+    {
+        const auto cpuHash = chip8CPU_.StateHash();
+        const uint64_t words[3] = {cpuHash.Low, cpuHash.High, instructionsSinceLastTick_};
+        return HashBytes128(words, sizeof(words));
+    }
 }
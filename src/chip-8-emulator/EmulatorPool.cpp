@@ -0,0 +1,34 @@
+#include "EmulatorPool.h"
+
+namespace SKChip8
+{
+    std::unique_ptr<Emulator> EmulatorPool::Acquire(const Emulator &source)
+    {
+        if (free_.empty())
+        {
+            return source.Clone();
+        }
+
+        auto emulator = std::move(free_.back());
+        free_.pop_back();
+        source.CloneInto(*emulator);
+        return emulator;
+    }
+
+    void EmulatorPool::Release(std::unique_ptr<Emulator> emulator)
+    {
+        if (emulator)
+        {
+            free_.push_back(std::move(emulator));
+        }
+    }
+
+    void EmulatorPool::Reserve(size_t count)
+    {
+        free_.reserve(count);
+        while (free_.size() < count)
+        {
+            free_.push_back(std::make_unique<Emulator>());
+        }
+    }
+}
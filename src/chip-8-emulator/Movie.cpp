@@ -0,0 +1,223 @@
+#include "Movie.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+    static constexpr uint8_t MOVIE_MAGIC[4] = {'C', '8', 'M', 'V'};
+    static constexpr uint16_t MOVIE_VERSION = 1;
+    static constexpr size_t MOVIE_HEADER_SIZE = 4 + 2 + 2 + 16 + 4 + 8 + 16 + 8 + 4;
+    static constexpr size_t MOVIE_EVENT_SIZE = 8 + 2;
+}
+
+namespace SKChip8
+{
+    void Movie::Save(const std::string &path) const
+    {
+        std::vector<uint8_t> bytes(MOVIE_HEADER_SIZE + MOVIE_EVENT_SIZE * Events.size());
+        auto out = bytes.data();
+
+        std::memcpy(out, MOVIE_MAGIC, sizeof(MOVIE_MAGIC));
+        StoreLE(out + 4, MOVIE_VERSION, 2);
+        StoreLE(out + 6, 0, 2);
+        StoreLE(out + 8, ROMHash.Low, 8);
+        StoreLE(out + 16, ROMHash.High, 8);
+        StoreLE(out + 24, Seed, 4);
+        StoreLE(out + 28, Length, 8);
+        StoreLE(out + 36, FinalStateHash.Low, 8);
+        StoreLE(out + 44, FinalStateHash.High, 8);
+        StoreLE(out + 52, FinalFrameHash, 8);
+        StoreLE(out + 60, Events.size(), 4);
+        out += MOVIE_HEADER_SIZE;
+
+        for (const auto &event : Events)
+        {
+            StoreLE(out, event.Cycle, 8);
+            StoreLE(out + 8, event.KeyMask, 2);
+            out += MOVIE_EVENT_SIZE;
+        }
+
+        std::ofstream ofs(path, std::ios::out | std::ios::binary);
+        if (!ofs.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+        ofs.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    Movie Movie::Load(const std::string &path)
+    {
+        std::ifstream ifs(path, std::ios::in | std::ios::binary);
+        if (!ifs.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        const std::vector<uint8_t> bytes(
+            (std::istreambuf_iterator<char>(ifs)),
+            std::istreambuf_iterator<char>());
+
+        if (bytes.size() < MOVIE_HEADER_SIZE || std::memcmp(bytes.data(), MOVIE_MAGIC, sizeof(MOVIE_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a movie file: " + path);
+        }
+
+        const auto in = bytes.data();
+        if (LoadLE(in + 4, 2) != MOVIE_VERSION)
+        {
+            throw std::runtime_error("Unsupported movie version in " + path);
+        }
+
+        Movie movie;
+        movie.ROMHash = Hash128{LoadLE(in + 8, 8), LoadLE(in + 16, 8)};
+        movie.Seed = static_cast<uint32_t>(LoadLE(in + 24, 4));
+        movie.Length = LoadLE(in + 28, 8);
+        movie.FinalStateHash = Hash128{LoadLE(in + 36, 8), LoadLE(in + 44, 8)};
+        movie.FinalFrameHash = LoadLE(in + 52, 8);
+
+        const auto count = LoadLE(in + 60, 4);
+        if (bytes.size() != MOVIE_HEADER_SIZE + MOVIE_EVENT_SIZE * count)
+        {
+            throw std::runtime_error("Truncated movie file: " + path);
+        }
+
+        movie.Events.resize(count);
+        auto cursor = in + MOVIE_HEADER_SIZE;
+        for (auto &event : movie.Events)
+        {
+            event.Cycle = LoadLE(cursor, 8);
+            event.KeyMask = static_cast<uint16_t>(LoadLE(cursor + 8, 2));
+            cursor += MOVIE_EVENT_SIZE;
+        }
+
+        return movie;
+    }
+
+    uint64_t FrameHash(const Emulator &emulator)
+    {
+        const auto &frame = emulator.GetCPU().GetPackedFrameBuffer();
+        return HashBytes(frame.data(), frame.size());
+    }
+
+    void MovieRecorder::Begin(Emulator &emulator, uint32_t seed)
+    {
+        emulator.Reset();
+        emulator.SeedRandom(seed);
+
+        movie_ = Movie{};
+        movie_.ROMHash = emulator.GetROMHash();
+        movie_.Seed = seed;
+        lastMask_ = 0;
+        recording_ = true;
+    }
+
+    void MovieRecorder::Observe(const Emulator &emulator)
+    {
+        if (!recording_)
+        {
+            return;
+        }
+
+        const auto cycle = emulator.GetCycleCount();
+        auto &events = movie_.Events;
+        if (!events.empty() && events.back().Cycle > cycle)
+        {
+            // the emulator went back in time, forget the future
+            events.erase(std::upper_bound(events.begin(), events.end(), cycle,
+                                          [](uint64_t c, const MovieEvent &event)
+                                          { return c < event.Cycle; }),
+                         events.end());
+            lastMask_ = events.empty() ? 0 : events.back().KeyMask;
+        }
+
+        const auto mask = emulator.GetKeyMask();
+        if (mask == lastMask_)
+        {
+            return;
+        }
+
+        if (!events.empty() && events.back().Cycle == cycle)
+        {
+            events.back().KeyMask = mask;
+        }
+        else
+        {
+            events.push_back(MovieEvent{cycle, mask});
+        }
+        lastMask_ = mask;
+    }
+
+    Movie MovieRecorder::Finish(const Emulator &emulator)
+    {
+        Observe(emulator);
+        recording_ = false;
+
+        movie_.Length = emulator.GetCycleCount();
+        movie_.FinalStateHash = emulator.StateHash();
+        movie_.FinalFrameHash = FrameHash(emulator);
+        return std::move(movie_);
+    }
+
+    void MoviePlayer::Begin(Emulator &emulator)
+    {
+        if (emulator.GetROMHash() != movie_.ROMHash)
+        {
+            throw std::runtime_error("Movie was recorded with a different ROM");
+        }
+
+        emulator.Reset();
+        emulator.SeedRandom(movie_.Seed);
+        nextEvent_ = 0;
+    }
+
+    bool MoviePlayer::RunTo(Emulator &emulator, uint64_t cycle)
+    {
+        return RunTo(emulator, cycle, [](Emulator &target, uint64_t count)
+                     { target.Run(count); });
+    }
+
+    bool MoviePlayer::RunTo(Emulator &emulator, uint64_t cycle, const RunFunction &run)
+    {
+        cycle = std::min(cycle, movie_.Length);
+
+        const auto &events = movie_.Events;
+        while (nextEvent_ < events.size() && events[nextEvent_].Cycle <= cycle)
+        {
+            const auto &event = events[nextEvent_++];
+            if (event.Cycle > emulator.GetCycleCount())
+            {
+                run(emulator, event.Cycle - emulator.GetCycleCount());
+            }
+            emulator.SetKeyMask(event.KeyMask);
+        }
+
+        if (cycle > emulator.GetCycleCount())
+        {
+            run(emulator, cycle - emulator.GetCycleCount());
+        }
+
+        return emulator.GetCycleCount() < movie_.Length;
+    }
+
+    void MoviePlayer::Resync(const Emulator &emulator)
+    {
+        const auto &events = movie_.Events;
+        nextEvent_ = std::upper_bound(events.begin(), events.end(), emulator.GetCycleCount(),
+                                      [](uint64_t cycle, const MovieEvent &event)
+                                      { return cycle < event.Cycle; }) -
+                     events.begin();
+    }
+
+    bool MoviePlayer::Verify(const Emulator &emulator) const
+    {
+        return emulator.GetCycleCount() == movie_.Length &&
+               emulator.StateHash() == movie_.FinalStateHash &&
+               FrameHash(emulator) == movie_.FinalFrameHash;
+    }
+}
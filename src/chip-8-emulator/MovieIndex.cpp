@@ -0,0 +1,214 @@
+#include "MovieIndex.h"
+
+#include <Utils/ByteOrder.h>
+#include <Utils/DeltaCodec.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+    static constexpr uint8_t MOVIE_INDEX_MAGIC[4] = {'C', '8', 'K', 'I'};
+    static constexpr uint16_t MOVIE_INDEX_VERSION = 1;
+    static constexpr size_t MOVIE_INDEX_HEADER_SIZE = 4 + 2 + 2 + 16 + 4 + 8 + 16 + 8 + 4;
+}
+
+namespace SKChip8
+{
+    MovieIndex MovieIndex::Build(const Movie &movie, Emulator &emulator, uint64_t interval)
+    {
+        if (interval == 0)
+        {
+            throw std::invalid_argument("Keyframe interval must be positive");
+        }
+
+        MovieIndex index;
+        index.ROMHash_ = movie.ROMHash;
+        index.seed_ = movie.Seed;
+        index.length_ = movie.Length;
+        index.finalStateHash_ = movie.FinalStateHash;
+        index.interval_ = interval;
+
+        MoviePlayer player(movie);
+        player.Begin(emulator);
+
+        Emulator::SaveStateBuffer state;
+        for (uint64_t cycle = 0; cycle <= movie.Length; cycle += interval)
+        {
+            player.RunTo(emulator, cycle);
+            emulator.SaveState(state);
+
+            Keyframe keyframe{cycle, {}};
+            EncodeXorDelta(nullptr, state.data(), state.size(), keyframe.State);
+            index.keyframes_.push_back(std::move(keyframe));
+        }
+
+        return index;
+    }
+
+    bool MovieIndex::matches(const Movie &movie) const
+    {
+        return ROMHash_ == movie.ROMHash &&
+               seed_ == movie.Seed &&
+               length_ == movie.Length &&
+               finalStateHash_ == movie.FinalStateHash;
+    }
+
+    size_t MovieIndex::GetEncodedBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto &keyframe : keyframes_)
+        {
+            bytes += keyframe.State.size();
+        }
+        return bytes;
+    }
+
+    void MovieIndex::Save(const std::string &path) const
+    {
+        std::vector<uint8_t> bytes(MOVIE_INDEX_HEADER_SIZE);
+        auto out = bytes.data();
+        std::memcpy(out, MOVIE_INDEX_MAGIC, sizeof(MOVIE_INDEX_MAGIC));
+        StoreLE(out + 4, MOVIE_INDEX_VERSION, 2);
+        StoreLE(out + 6, 0, 2);
+        StoreLE(out + 8, ROMHash_.Low, 8);
+        StoreLE(out + 16, ROMHash_.High, 8);
+        StoreLE(out + 24, seed_, 4);
+        StoreLE(out + 28, length_, 8);
+        StoreLE(out + 36, finalStateHash_.Low, 8);
+        StoreLE(out + 44, finalStateHash_.High, 8);
+        StoreLE(out + 52, interval_, 8);
+        StoreLE(out + 60, keyframes_.size(), 4);
+
+        for (const auto &keyframe : keyframes_)
+        {
+            uint8_t header[12];
+            StoreLE(header, keyframe.Cycle, 8);
+            StoreLE(header + 8, keyframe.State.size(), 4);
+            bytes.insert(bytes.end(), header, header + sizeof(header));
+            bytes.insert(bytes.end(), keyframe.State.begin(), keyframe.State.end());
+        }
+
+        std::ofstream ofs(path, std::ios::out | std::ios::binary);
+        if (!ofs.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+        ofs.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    MovieIndex MovieIndex::Load(const std::string &path, const Movie &movie)
+    {
+        std::ifstream ifs(path, std::ios::in | std::ios::binary);
+        if (!ifs.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        const std::vector<uint8_t> bytes(
+            (std::istreambuf_iterator<char>(ifs)),
+            std::istreambuf_iterator<char>());
+
+        if (bytes.size() < MOVIE_INDEX_HEADER_SIZE ||
+            std::memcmp(bytes.data(), MOVIE_INDEX_MAGIC, sizeof(MOVIE_INDEX_MAGIC)) != 0 ||
+            LoadLE(bytes.data() + 4, 2) != MOVIE_INDEX_VERSION)
+        {
+            throw std::runtime_error("Not a movie index of a supported version: " + path);
+        }
+
+        const auto in = bytes.data();
+        MovieIndex index;
+        index.ROMHash_ = Hash128{LoadLE(in + 8, 8), LoadLE(in + 16, 8)};
+        index.seed_ = static_cast<uint32_t>(LoadLE(in + 24, 4));
+        index.length_ = LoadLE(in + 28, 8);
+        index.finalStateHash_ = Hash128{LoadLE(in + 36, 8), LoadLE(in + 44, 8)};
+        index.interval_ = LoadLE(in + 52, 8);
+        if (!index.matches(movie) || index.interval_ == 0)
+        {
+            throw std::runtime_error("Movie index is stale: " + path);
+        }
+
+        const auto count = LoadLE(in + 60, 4);
+        size_t offset = MOVIE_INDEX_HEADER_SIZE;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (bytes.size() - offset < 12)
+            {
+                throw std::runtime_error("Truncated movie index: " + path);
+            }
+            const auto cycle = LoadLE(in + offset, 8);
+            const auto size = LoadLE(in + offset + 8, 4);
+            offset += 12;
+            if (bytes.size() - offset < size)
+            {
+                throw std::runtime_error("Truncated movie index: " + path);
+            }
+
+            index.keyframes_.push_back(Keyframe{cycle, std::vector<uint8_t>(in + offset, in + offset + size)});
+            offset += size;
+        }
+
+        if (index.keyframes_.empty() || index.keyframes_.front().Cycle != 0)
+        {
+            throw std::runtime_error("Movie index has no starting keyframe: " + path);
+        }
+
+        return index;
+    }
+
+    std::string MovieIndex::PathFor(const std::string &moviePath)
+    {
+        return moviePath + ".idx";
+    }
+
+    MovieIndex MovieIndex::Open(const std::string &moviePath, const Movie &movie, Emulator &emulator, uint64_t interval)
+    {
+        const auto path = PathFor(moviePath);
+        try
+        {
+            auto index = Load(path, movie);
+            if (index.interval_ == interval)
+            {
+                return index;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            // missing or stale, rebuild it below
+        }
+
+        auto index = Build(movie, emulator, interval);
+        index.Save(path);
+        return index;
+    }
+
+    void MovieIndex::Seek(MoviePlayer &player, Emulator &emulator, uint64_t cycle) const
+    {
+        cycle = std::min(cycle, length_);
+
+        // the last keyframe at or before cycle. if playback is already between
+        // that keyframe and cycle, running on from here is cheaper
+        const auto it = std::upper_bound(keyframes_.begin(), keyframes_.end(), cycle,
+                                         [](uint64_t c, const Keyframe &keyframe)
+                                         { return c < keyframe.Cycle; }) -
+                        1;
+
+        const auto current = emulator.GetCycleCount();
+        if (current < it->Cycle || current > cycle)
+        {
+            Emulator::SaveStateBuffer state;
+            state.fill(0);
+            if (ApplyXorDelta(it->State.data(), it->State.size(), state.data(), state.size()) == 0)
+            {
+                throw std::runtime_error("Movie index keyframe is corrupt");
+            }
+            emulator.LoadState(state);
+            player.Resync(emulator);
+        }
+
+        player.RunTo(emulator, cycle);
+    }
+}
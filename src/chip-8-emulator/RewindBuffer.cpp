@@ -0,0 +1,150 @@
+#include "RewindBuffer.h"
+
+#include <Utils/DeltaCodec.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    RewindBuffer::RewindBuffer(size_t capacityBytes, uint32_t keyframeInterval)
+        : data_(capacityBytes),
+          head_(0),
+          keyframeInterval_(keyframeInterval > 0 ? keyframeInterval : 1),
+          framesSinceKeyframe_(0)
+    {
+        // an incompressible keyframe plus its control bytes has to fit a few times over
+        if (capacityBytes < 4 * 2 * SAVE_STATE_SIZE)
+        {
+            throw std::invalid_argument("Rewind buffer capacity is too small");
+        }
+        scratch_.reserve(2 * SAVE_STATE_SIZE);
+    }
+
+    void RewindBuffer::Clear()
+    {
+        records_.clear();
+        head_ = 0;
+        framesSinceKeyframe_ = 0;
+    }
+
+    size_t RewindBuffer::GetUsedBytes() const
+    {
+        size_t used = 0;
+        for (const auto &record : records_)
+        {
+            used += record.Size;
+        }
+        return used;
+    }
+
+    void RewindBuffer::evict(size_t begin, size_t end)
+    {
+        while (!records_.empty() &&
+               records_.front().Offset < end &&
+               records_.front().Offset + records_.front().Size > begin)
+        {
+            records_.pop_front();
+        }
+    }
+
+    void RewindBuffer::reserve(size_t size)
+    {
+        // records are laid out in age order around the ring, so whatever is
+        // in the way of the write is always at the front of the queue
+        if (head_ + size > data_.size())
+        {
+            evict(head_, data_.size());
+            head_ = 0;
+        }
+        evict(head_, head_ + size);
+
+        // deltas are useless without the keyframe they build on
+        while (!records_.empty() && !records_.front().Keyframe)
+        {
+            records_.pop_front();
+        }
+    }
+
+    void RewindBuffer::Capture(const Emulator &emulator)
+    {
+        emulator.SaveState(current_);
+
+        bool keyframe = records_.empty() || framesSinceKeyframe_ + 1 >= keyframeInterval_;
+        scratch_.clear();
+        EncodeXorDelta(keyframe ? nullptr : previous_.data(), current_.data(), current_.size(), scratch_);
+
+        reserve(scratch_.size());
+
+        // making room can evict the keyframe this delta builds on, and with
+        // it every delta after it. start a new group rather than storing a
+        // delta with nothing to apply it to
+        if (!keyframe && records_.empty())
+        {
+            keyframe = true;
+            scratch_.clear();
+            EncodeXorDelta(nullptr, current_.data(), current_.size(), scratch_);
+            reserve(scratch_.size());
+        }
+        std::memcpy(data_.data() + head_, scratch_.data(), scratch_.size());
+        records_.push_back(Record{head_, scratch_.size(), keyframe});
+        head_ += scratch_.size();
+
+        framesSinceKeyframe_ = keyframe ? 0 : framesSinceKeyframe_ + 1;
+        previous_ = current_;
+    }
+
+    void RewindBuffer::decode(size_t index, Emulator::SaveStateBuffer &state) const
+    {
+        auto keyframe = index;
+        while (!records_[keyframe].Keyframe)
+        {
+            keyframe--;
+        }
+
+        state.fill(0);
+        for (auto i = keyframe; i <= index; ++i)
+        {
+            const auto &record = records_[i];
+            ApplyXorDelta(data_.data() + record.Offset, record.Size, state.data(), state.size());
+        }
+    }
+
+    bool RewindBuffer::Seek(size_t framesBack, Emulator &emulator) const
+    {
+        if (framesBack >= records_.size())
+        {
+            return false;
+        }
+
+        Emulator::SaveStateBuffer state;
+        decode(records_.size() - 1 - framesBack, state);
+        emulator.LoadState(state);
+        return true;
+    }
+
+    void RewindBuffer::Truncate(size_t framesBack)
+    {
+        if (framesBack >= records_.size())
+        {
+            Clear();
+            return;
+        }
+        if (framesBack == 0)
+        {
+            return;
+        }
+
+        records_.resize(records_.size() - framesBack);
+        decode(records_.size() - 1, previous_);
+
+        const auto &newest = records_.back();
+        head_ = newest.Offset + newest.Size;
+
+        framesSinceKeyframe_ = 0;
+        for (auto i = records_.size() - 1; !records_[i].Keyframe; --i)
+        {
+            framesSinceKeyframe_++;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include "StateSnapshot.h"
+#include "Emulator.h"
+
+namespace SKChip8
+{
+    SnapshotPublisher::SnapshotPublisher() : buffers_{}, front_(0), generation_(0)
+    {
+        pins_[0] = 0;
+        pins_[1] = 0;
+    }
+
+    bool SnapshotPublisher::Publish(const Emulator &emulator)
+    {
+        // the pin check and Acquire's recheck of front_ are both sequentially
+        // consistent, so a reader that pinned the back buffer either is seen
+        // here or sees the flip that made it the back buffer and retries
+        const int back = 1 - front_.load();
+        if (pins_[back].load() > 0)
+        {
+            return false;
+        }
+
+        const auto &cpu = emulator.GetCPU();
+        auto &snapshot = buffers_[back];
+        snapshot.Generation = ++generation_;
+        snapshot.CycleCount = cpu.GetCycleCount();
+        snapshot.PC = cpu.GetPC();
+        snapshot.CurrentInstruction = cpu.GetCurrentInstruction();
+        snapshot.IndexPointer = cpu.GetIndexPointer();
+        snapshot.Registers = cpu.GetRegisters();
+        snapshot.DelayTimer = cpu.GetDelayTimer();
+        snapshot.SoundTimer = cpu.GetSoundTimer();
+        snapshot.KeyState = cpu.GetKeyState();
+        snapshot.Memory = cpu.GetMemory();
+        snapshot.FrameBuffer = cpu.GetPackedFrameBuffer();
+
+        front_.store(back);
+        return true;
+    }
+
+    SnapshotPublisher::View SnapshotPublisher::Acquire() const
+    {
+        while (true)
+        {
+            const int front = front_.load();
+            pins_[front].fetch_add(1);
+
+            // a flip between the load and the pin may have handed this buffer
+            // to the publisher
+            if (front_.load() == front)
+            {
+                return View(&buffers_[front], &pins_[front]);
+            }
+            pins_[front].fetch_sub(1);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include "UndoJournal.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    // the largest record is a display clear: the scalars plus the whole framebuffer
+    static constexpr size_t MAX_RECORD_SIZE = 512;
+
+    UndoJournal::UndoJournal(size_t capacityBytes)
+        : data_(capacityBytes),
+          head_(0)
+    {
+        if (capacityBytes < 4 * MAX_RECORD_SIZE)
+        {
+            throw std::invalid_argument("Undo journal capacity is too small");
+        }
+        scratch_.reserve(MAX_RECORD_SIZE);
+    }
+
+    void UndoJournal::Clear()
+    {
+        records_.clear();
+        head_ = 0;
+    }
+
+    std::vector<uint8_t> &UndoJournal::BeginRecord()
+    {
+        scratch_.clear();
+        return scratch_;
+    }
+
+    void UndoJournal::CommitRecord()
+    {
+        const auto size = scratch_.size();
+        if (size > data_.size())
+        {
+            throw std::invalid_argument("Undo record is larger than the journal");
+        }
+
+        // same layout as the rewind buffer: records sit in age order around
+        // the ring so whatever is in the way is at the front of the queue
+        if (head_ + size > data_.size())
+        {
+            while (!records_.empty() && records_.front().Offset >= head_)
+            {
+                records_.pop_front();
+            }
+            head_ = 0;
+        }
+        while (!records_.empty() &&
+               records_.front().Offset >= head_ &&
+               records_.front().Offset < head_ + size)
+        {
+            records_.pop_front();
+        }
+
+        std::memcpy(data_.data() + head_, scratch_.data(), size);
+        records_.push_back(Record{head_, size});
+        head_ += size;
+    }
+
+    const std::vector<uint8_t> *UndoJournal::PopRecord()
+    {
+        if (records_.empty())
+        {
+            return nullptr;
+        }
+
+        const auto record = records_.back();
+        records_.pop_back();
+        head_ = record.Offset;
+
+        const auto begin = data_.data() + record.Offset;
+        scratch_.assign(begin, begin + record.Size);
+        return &scratch_;
+    }
+}
@@ -0,0 +1,205 @@
+#include "SessionHost.h"
+
+#include <algorithm>
+#include <ctime>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    static constexpr auto FRAME_PERIOD = std::chrono::duration_cast<EmulatorDuration>(
+        std::chrono::duration<double>(1.0 / SessionHost::FRAME_HZ));
+
+    SessionHost::SessionHost(size_t threadCount) : threadCount_(std::max<size_t>(threadCount, 1)),
+                                                   running_(false),
+                                                   startCPUTime_(0)
+    {
+    }
+
+    SessionHost::~SessionHost()
+    {
+        Stop();
+    }
+
+    SessionHost::SessionId SessionHost::AddSession(std::unique_ptr<Emulator> emulator)
+    {
+        if (running_)
+        {
+            throw std::logic_error("Sessions cannot be added while the host is running");
+        }
+
+        auto session = std::make_unique<Session>();
+        session->Machine = std::move(emulator);
+        sessions_.push_back(std::move(session));
+        return static_cast<SessionId>(sessions_.size() - 1);
+    }
+
+    uint64_t SessionHost::toTick(EmulatorClock::time_point time) const
+    {
+        // round up so that sessions are never woken before their deadline
+        const auto elapsed = time - epoch_;
+        return (elapsed + TICK - EmulatorDuration(1)) / TICK;
+    }
+
+    uint64_t SessionHost::elapsedTicks(EmulatorClock::time_point time) const
+    {
+        // round down, a tick only counts as reached once it has fully passed.
+        // together with toTick this makes a timer fire no earlier than its deadline
+        return (time - epoch_) / TICK;
+    }
+
+    void SessionHost::Start()
+    {
+        if (running_)
+        {
+            return;
+        }
+
+        epoch_ = EmulatorClock::now();
+        startCPUTime_ = std::clock();
+        wheel_ = TimerWheel(0);
+
+        // spread the first frames over one period so the sessions don't all
+        // wake on the same tick
+        for (size_t i = 0; i < sessions_.size(); ++i)
+        {
+            auto &session = *sessions_[i];
+            session.Deadline = epoch_ + FRAME_PERIOD * i / sessions_.size();
+            wheel_.Schedule(static_cast<SessionId>(i), toTick(session.Deadline));
+        }
+
+        running_ = true;
+        scheduler_ = std::thread(&SessionHost::schedulerLoop, this);
+        for (size_t i = 0; i < threadCount_; ++i)
+        {
+            workers_.emplace_back(&SessionHost::workerLoop, this);
+        }
+    }
+
+    void SessionHost::Stop()
+    {
+        if (!running_)
+        {
+            return;
+        }
+
+        {
+            // under the lock, so a worker can't check the predicate and then
+            // block after the notify has already gone out
+            std::lock_guard<std::mutex> lock(readyMutex_);
+            running_ = false;
+        }
+        readyCondition_.notify_all();
+        scheduler_.join();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+        ready_.clear();
+    }
+
+    void SessionHost::schedulerLoop()
+    {
+        std::vector<SessionId> due;
+        auto next = EmulatorClock::now();
+        while (running_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(wheelMutex_);
+                wheel_.Advance(elapsedTicks(EmulatorClock::now()), [&](TimerWheel::TimerId id)
+                               { due.push_back(id); });
+            }
+
+            if (!due.empty())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(readyMutex_);
+                    ready_.insert(ready_.end(), due.begin(), due.end());
+                }
+                readyCondition_.notify_all();
+                due.clear();
+            }
+
+            next += TICK;
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    void SessionHost::workerLoop()
+    {
+        while (true)
+        {
+            SessionId id;
+            {
+                std::unique_lock<std::mutex> lock(readyMutex_);
+                readyCondition_.wait(lock, [this]
+                                     { return !ready_.empty() || !running_; });
+                if (!running_)
+                {
+                    return;
+                }
+                id = ready_.front();
+                ready_.pop_front();
+            }
+
+            auto &session = *sessions_[id];
+            runFrame(session);
+
+            std::lock_guard<std::mutex> lock(wheelMutex_);
+            wheel_.Schedule(id, toTick(session.Deadline));
+        }
+    }
+
+    void SessionHost::runFrame(Session &session)
+    {
+        const auto start = EmulatorClock::now();
+        const auto lateness = start > session.Deadline
+                                  ? static_cast<uint64_t>(EmulatorDuration(start - session.Deadline).count())
+                                  : 0;
+
+        session.Machine->SetKeyMask(session.KeyMask.load(std::memory_order_relaxed));
+
+        session.InstructionCredit += EMULATOR_CPU_HZ / FRAME_HZ;
+        const auto instructions = static_cast<uint64_t>(session.InstructionCredit);
+        session.InstructionCredit -= instructions;
+        session.Machine->Run(instructions);
+
+        session.Frames.fetch_add(1, std::memory_order_relaxed);
+        session.TotalLatenessNs.fetch_add(lateness, std::memory_order_relaxed);
+        if (lateness > session.MaxLatenessNs.load(std::memory_order_relaxed))
+        {
+            session.MaxLatenessNs.store(lateness, std::memory_order_relaxed);
+        }
+
+        // if a session falls more than a frame behind, drop the missed frames
+        // rather than running them back to back
+        session.Deadline += FRAME_PERIOD;
+        if (session.Deadline < start)
+        {
+            session.Deadline = start + FRAME_PERIOD;
+        }
+    }
+
+    void SessionHost::SetKeyMask(SessionId session, uint16_t mask)
+    {
+        sessions_.at(session)->KeyMask.store(mask, std::memory_order_relaxed);
+    }
+
+    SessionStats SessionHost::GetSessionStats(SessionId id) const
+    {
+        const auto &session = *sessions_.at(id);
+        SessionStats stats;
+        stats.Frames = session.Frames.load(std::memory_order_relaxed);
+        const auto total = session.TotalLatenessNs.load(std::memory_order_relaxed);
+        stats.MeanLatenessMs = stats.Frames > 0 ? total / 1.0e6 / stats.Frames : 0.0;
+        stats.MaxLatenessMs = session.MaxLatenessNs.load(std::memory_order_relaxed) / 1.0e6;
+        return stats;
+    }
+
+    double SessionHost::GetCPUUsage() const
+    {
+        const double wall = std::chrono::duration<double>(EmulatorClock::now() - epoch_).count();
+        const double cpu = double(std::clock() - startCPUTime_) / CLOCKS_PER_SEC;
+        return wall > 0 ? cpu / wall : 0.0;
+    }
+}
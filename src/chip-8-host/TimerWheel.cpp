@@ -0,0 +1,90 @@
+#include "TimerWheel.h"
+
+namespace SKChip8
+{
+    TimerWheel::TimerWheel(uint64_t startTick) : currentTick_(startTick), size_(0)
+    {
+    }
+
+    void TimerWheel::Schedule(TimerId id, uint64_t deadline)
+    {
+        place(Entry{id, deadline < currentTick_ ? currentTick_ : deadline});
+        size_++;
+    }
+
+    void TimerWheel::place(const Entry &entry)
+    {
+        const auto delta = entry.Deadline - currentTick_;
+        if (delta < INNER_SLOTS)
+        {
+            inner_[entry.Deadline & (INNER_SLOTS - 1)].push_back(entry);
+        }
+        else if (delta < INNER_SLOTS * OUTER_SLOTS)
+        {
+            outer_[(entry.Deadline >> INNER_BITS) & (OUTER_SLOTS - 1)].push_back(entry);
+        }
+        else
+        {
+            overflow_.push_back(entry);
+        }
+    }
+
+    void TimerWheel::cascade()
+    {
+        // called when currentTick_ starts a new inner revolution. the outer slot
+        // for this revolution holds everything due within the next INNER_SLOTS ticks
+        auto &slot = outer_[(currentTick_ >> INNER_BITS) & (OUTER_SLOTS - 1)];
+        scratch_.swap(slot);
+        for (const auto &entry : scratch_)
+        {
+            place(entry);
+        }
+        scratch_.clear();
+
+        // once per outer revolution, pull in overflow timers that are now in range
+        if (((currentTick_ >> INNER_BITS) & (OUTER_SLOTS - 1)) == 0 && !overflow_.empty())
+        {
+            scratch_.swap(overflow_);
+            for (const auto &entry : scratch_)
+            {
+                place(entry);
+            }
+            scratch_.clear();
+        }
+    }
+
+    void TimerWheel::Advance(uint64_t now, const Callback &fire)
+    {
+        while (currentTick_ <= now)
+        {
+            if ((currentTick_ & (INNER_SLOTS - 1)) == 0)
+            {
+                cascade();
+            }
+
+            auto &slot = inner_[currentTick_ & (INNER_SLOTS - 1)];
+            if (!slot.empty())
+            {
+                // fire may reschedule into this wheel, so detach the slot first
+                std::vector<Entry> expired;
+                expired.swap(slot);
+                size_ -= expired.size();
+                currentTick_++;
+                for (const auto &entry : expired)
+                {
+                    fire(entry.Id);
+                }
+
+                // hand the storage back so steady state doesn't allocate
+                expired.clear();
+                if (slot.empty())
+                {
+                    slot.swap(expired);
+                }
+                continue;
+            }
+
+            currentTick_++;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include "RollbackSession.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    RollbackSession::RollbackSession(const Emulator &initial, uint8_t playerCount, uint8_t localPlayer)
+        : emulator_(initial),
+          playerCount_(playerCount),
+          localPlayer_(localPlayer),
+          frame_(0),
+          rollbackFrame_(0),
+          hashedFrames_(0),
+          rollbacks_(0),
+          maxResimulated_(0)
+    {
+        if (playerCount == 0 || playerCount > MAX_PLAYERS || localPlayer >= playerCount)
+        {
+            throw std::invalid_argument("Invalid player configuration");
+        }
+
+        for (auto &used : usedInputs_)
+        {
+            used.fill(0);
+        }
+        for (auto &entry : hashes_)
+        {
+            entry = HashEntry{~0u, 0};
+        }
+        hashes_[0] = HashEntry{0, emulator_.StateHash().Low};
+    }
+
+    uint64_t RollbackSession::InstructionsForFrame(uint32_t frame)
+    {
+        const auto before = static_cast<uint64_t>(frame * (EMULATOR_CPU_HZ / FRAME_HZ));
+        const auto after = static_cast<uint64_t>((frame + 1) * (EMULATOR_CPU_HZ / FRAME_HZ));
+        return after - before;
+    }
+
+    uint32_t RollbackSession::GetConfirmedFrame() const
+    {
+        uint32_t confirmed = frame_;
+        for (uint8_t player = 0; player < playerCount_; ++player)
+        {
+            confirmed = std::min(confirmed, GetInputCount(player));
+        }
+        return confirmed;
+    }
+
+    uint16_t RollbackSession::inputFor(uint8_t player, uint32_t frame) const
+    {
+        const auto &inputs = inputs_[player];
+        if (frame < inputs.size())
+        {
+            return inputs[frame];
+        }
+
+        // predict that the player is still holding the same keys
+        return inputs.empty() ? 0 : inputs.back();
+    }
+
+    void RollbackSession::simulateFrame(uint32_t frame)
+    {
+        emulator_.CloneInto(snapshots_[frame % SNAPSHOT_COUNT]);
+
+        uint16_t mask = 0;
+        for (uint8_t player = 0; player < playerCount_; ++player)
+        {
+            const auto input = inputFor(player, frame);
+            usedInputs_[player][frame % SNAPSHOT_COUNT] = input;
+            mask |= input;
+        }
+
+        emulator_.SetKeyMask(mask);
+        emulator_.Run(InstructionsForFrame(frame));
+    }
+
+    bool RollbackSession::AdvanceFrame(uint16_t localMask)
+    {
+        if (frame_ - GetConfirmedFrame() >= MAX_ROLLBACK_FRAMES)
+        {
+            return false;
+        }
+
+        inputs_[localPlayer_].push_back(localMask);
+
+        ApplyRollback();
+
+        simulateFrame(frame_);
+        frame_++;
+        rollbackFrame_ = frame_;
+
+        recordConfirmedHashes();
+        return true;
+    }
+
+    void RollbackSession::ApplyRollback()
+    {
+        if (rollbackFrame_ < frame_)
+        {
+            emulator_ = snapshots_[rollbackFrame_ % SNAPSHOT_COUNT];
+            for (auto frame = rollbackFrame_; frame < frame_; ++frame)
+            {
+                simulateFrame(frame);
+            }
+
+            rollbacks_++;
+            maxResimulated_ = std::max(maxResimulated_, frame_ - rollbackFrame_);
+            rollbackFrame_ = frame_;
+        }
+
+        recordConfirmedHashes();
+    }
+
+    void RollbackSession::AddRemoteInput(uint8_t player, uint32_t frame, uint16_t mask)
+    {
+        if (player >= playerCount_ || player == localPlayer_)
+        {
+            return;
+        }
+
+        auto &inputs = inputs_[player];
+        if (frame != inputs.size())
+        {
+            // either a duplicate or a gap, packets repeat recent frames so a
+            // later one will fill it in
+            return;
+        }
+
+        inputs.push_back(mask);
+
+        // the snapshot ring always covers every unconfirmed frame, see AdvanceFrame
+        if (frame < frame_ && usedInputs_[player][frame % SNAPSHOT_COUNT] != mask)
+        {
+            rollbackFrame_ = std::min(rollbackFrame_, frame);
+        }
+    }
+
+    void RollbackSession::recordConfirmedHashes()
+    {
+        // the state at the start of a frame is final once every earlier frame
+        // has confirmed input and has been simulated with it
+        const auto confirmed = std::min(GetConfirmedFrame(), rollbackFrame_);
+        for (; hashedFrames_ < confirmed; ++hashedFrames_)
+        {
+            const auto frame = hashedFrames_ + 1;
+            const auto &state = frame == frame_ ? emulator_ : snapshots_[frame % SNAPSHOT_COUNT];
+            hashes_[frame % HASH_HISTORY] = HashEntry{frame, state.StateHash().Low};
+        }
+    }
+
+    bool RollbackSession::GetConfirmedHash(uint32_t frame, uint64_t &hash) const
+    {
+        const auto &entry = hashes_[frame % HASH_HISTORY];
+        if (entry.Frame != frame)
+        {
+            return false;
+        }
+
+        hash = entry.Hash;
+        return true;
+    }
+}
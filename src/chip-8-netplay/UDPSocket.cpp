@@ -0,0 +1,73 @@
+#include "UDPSocket.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace SKChip8
+{
+    UDPSocket::UDPSocket(uint16_t port)
+    {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error(std::string("Could not create socket: ") + std::strerror(errno));
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            close(fd_);
+            throw std::runtime_error("Could not bind UDP port " + std::to_string(port) + ": " + std::strerror(errno));
+        }
+
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    UDPSocket::~UDPSocket()
+    {
+        close(fd_);
+    }
+
+    UDPSocket::Endpoint UDPSocket::ParseEndpoint(const std::string &text)
+    {
+        const auto colon = text.rfind(':');
+        if (colon == std::string::npos)
+        {
+            throw std::invalid_argument("Expected host:port, got " + text);
+        }
+
+        in_addr address;
+        if (inet_pton(AF_INET, text.substr(0, colon).c_str(), &address) != 1)
+        {
+            throw std::invalid_argument("Invalid IPv4 address: " + text.substr(0, colon));
+        }
+
+        return Endpoint{address.s_addr, static_cast<uint16_t>(std::stoul(text.substr(colon + 1)))};
+    }
+
+    void UDPSocket::SendTo(const Endpoint &to, const void *data, size_t size)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = to.Address;
+        addr.sin_port = htons(to.Port);
+
+        // unreliable by design, a lost packet is covered by the next one
+        sendto(fd_, data, size, 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+
+    size_t UDPSocket::Receive(void *data, size_t capacity)
+    {
+        auto received = recv(fd_, data, capacity, 0);
+        return received > 0 ? static_cast<size_t>(received) : 0;
+    }
+}
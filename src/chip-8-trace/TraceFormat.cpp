@@ -0,0 +1,154 @@
+#include "TraceFormat.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <cstring>
+
+namespace
+{
+    void putVarint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // returns false on truncated or overlong input
+    bool getVarint(const uint8_t *&in, const uint8_t *end, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (in == end)
+            {
+                return false;
+            }
+            const auto byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+    int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+}
+
+namespace SKChip8
+{
+    void EncodeTraceBlock(const TraceRecord *records, size_t count, std::vector<uint8_t> &out)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const auto headerOffset = out.size();
+        out.resize(headerOffset + TRACE_BLOCK_HEADER_SIZE);
+
+        uint64_t previousCycle = records[0].Cycle;
+        uint16_t previousPC = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto &record = records[i];
+            putVarint(out, record.Cycle - previousCycle);
+            putVarint(out, zigzag(static_cast<int64_t>(record.PC) - previousPC));
+            out.push_back(static_cast<uint8_t>(record.Opcode));
+            out.push_back(static_cast<uint8_t>(record.Opcode >> 8));
+            putVarint(out, record.ChangedRegisters);
+
+            // the header already has the first record's registers
+            if (i > 0)
+            {
+                for (size_t reg = 0; reg < REG_COUNT; ++reg)
+                {
+                    if (record.ChangedRegisters & (1 << reg))
+                    {
+                        out.push_back(record.Registers[reg]);
+                    }
+                }
+            }
+
+            previousCycle = record.Cycle;
+            previousPC = record.PC;
+        }
+
+        const auto header = out.data() + headerOffset;
+        StoreLE(header, records[0].Cycle, 8);
+        StoreLE(header + 8, count, 4);
+        StoreLE(header + 12, out.size() - headerOffset - TRACE_BLOCK_HEADER_SIZE, 4);
+        std::memcpy(header + 16, records[0].Registers.data(), REG_COUNT);
+    }
+
+    size_t DecodeTraceBlock(const uint8_t *data, size_t size, std::vector<TraceRecord> &out)
+    {
+        if (size < TRACE_BLOCK_HEADER_SIZE)
+        {
+            return 0;
+        }
+
+        const auto firstCycle = LoadLE(data, 8);
+        const auto count = LoadLE(data + 8, 4);
+        const auto encodedSize = LoadLE(data + 12, 4);
+        if (count == 0 || encodedSize > size - TRACE_BLOCK_HEADER_SIZE)
+        {
+            return 0;
+        }
+
+        const auto firstOut = out.size();
+        auto in = data + TRACE_BLOCK_HEADER_SIZE;
+        const auto end = in + encodedSize;
+
+        TraceRecord record;
+        record.Cycle = firstCycle;
+        record.PC = 0;
+        std::memcpy(record.Registers.data(), data + 16, REG_COUNT);
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            uint64_t cycleDelta, pcDelta, mask;
+            if (!getVarint(in, end, cycleDelta) || !getVarint(in, end, pcDelta) || end - in < 2)
+            {
+                out.resize(firstOut);
+                return 0;
+            }
+            record.Cycle += cycleDelta;
+            record.PC = static_cast<uint16_t>(record.PC + unzigzag(pcDelta));
+            record.Opcode = static_cast<uint16_t>(in[0] | in[1] << 8);
+            in += 2;
+
+            if (!getVarint(in, end, mask) || mask > 0xFFFF)
+            {
+                out.resize(firstOut);
+                return 0;
+            }
+            record.ChangedRegisters = static_cast<uint16_t>(mask);
+
+            if (i > 0)
+            {
+                for (size_t reg = 0; reg < REG_COUNT; ++reg)
+                {
+                    if (mask & (1 << reg))
+                    {
+                        if (in == end)
+                        {
+                            out.resize(firstOut);
+                            return 0;
+                        }
+                        record.Registers[reg] = *in++;
+                    }
+                }
+            }
+
+            out.push_back(record);
+        }
+
+        return TRACE_BLOCK_HEADER_SIZE + encodedSize;
+    }
+}
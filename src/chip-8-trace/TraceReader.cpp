@@ -0,0 +1,203 @@
+#include "TraceReader.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SKChip8
+{
+    TraceReader::TraceReader(const std::string &path)
+        : fd_(-1),
+          data_(nullptr),
+          size_(0),
+          recordCount_(0),
+          lastCycle_(0),
+          cachedBlock_(~size_t(0))
+    {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        struct stat info;
+        if (::fstat(fd_, &info) != 0 || static_cast<size_t>(info.st_size) < TRACE_FILE_HEADER_SIZE)
+        {
+            ::close(fd_);
+            throw std::runtime_error("Not a trace file: " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+
+        const auto mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd_);
+            throw std::runtime_error("Could not map file: " + path);
+        }
+        data_ = static_cast<const uint8_t *>(mapping);
+
+        if (std::memcmp(data_, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || LoadLE(data_ + 4, 2) != TRACE_VERSION)
+        {
+            ::munmap(const_cast<uint8_t *>(data_), size_);
+            ::close(fd_);
+            throw std::runtime_error("Not a trace file of a supported version: " + path);
+        }
+
+        if (!readIndex())
+        {
+            scanBlocks();
+        }
+
+        for (const auto &block : blocks_)
+        {
+            recordCount_ += block.Records;
+        }
+        if (!blocks_.empty())
+        {
+            lastCycle_ = decode(blocks_.size() - 1).back().Cycle;
+        }
+    }
+
+    TraceReader::~TraceReader()
+    {
+        ::munmap(const_cast<uint8_t *>(data_), size_);
+        ::close(fd_);
+    }
+
+    bool TraceReader::readIndex()
+    {
+        if (size_ < TRACE_FILE_HEADER_SIZE + TRACE_FOOTER_SIZE)
+        {
+            return false;
+        }
+
+        const auto footer = data_ + size_ - TRACE_FOOTER_SIZE;
+        if (std::memcmp(footer + 12, TRACE_INDEX_MAGIC, sizeof(TRACE_INDEX_MAGIC)) != 0)
+        {
+            return false;
+        }
+
+        const auto indexOffset = LoadLE(footer, 8);
+        const auto blockCount = LoadLE(footer + 8, 4);
+        if (indexOffset < TRACE_FILE_HEADER_SIZE ||
+            indexOffset + blockCount * TRACE_INDEX_ENTRY_SIZE + TRACE_FOOTER_SIZE != size_)
+        {
+            return false;
+        }
+
+        auto entry = data_ + indexOffset;
+        for (uint64_t i = 0; i < blockCount; ++i, entry += TRACE_INDEX_ENTRY_SIZE)
+        {
+            const Block block{LoadLE(entry, 8), LoadLE(entry + 8, 8), static_cast<uint32_t>(LoadLE(entry + 16, 4))};
+            if (block.Offset + TRACE_BLOCK_HEADER_SIZE > indexOffset)
+            {
+                blocks_.clear();
+                return false;
+            }
+            blocks_.push_back(block);
+        }
+        return true;
+    }
+
+    void TraceReader::scanBlocks()
+    {
+        // no index, walk the block headers up to the first damaged block
+        uint64_t offset = TRACE_FILE_HEADER_SIZE;
+        while (size_ - offset >= TRACE_BLOCK_HEADER_SIZE)
+        {
+            const auto header = data_ + offset;
+            const auto records = LoadLE(header + 8, 4);
+            const auto encodedSize = LoadLE(header + 12, 4);
+            if (records == 0 || encodedSize > size_ - offset - TRACE_BLOCK_HEADER_SIZE)
+            {
+                break;
+            }
+
+            blocks_.push_back(Block{LoadLE(header, 8), offset, static_cast<uint32_t>(records)});
+            offset += TRACE_BLOCK_HEADER_SIZE + encodedSize;
+        }
+    }
+
+    uint64_t TraceReader::GetFirstCycle() const
+    {
+        return blocks_.empty() ? 0 : blocks_.front().FirstCycle;
+    }
+
+    size_t TraceReader::findBlock(uint64_t cycle) const
+    {
+        // first block starting after cycle, the one before it may contain it
+        const auto it = std::upper_bound(blocks_.begin(), blocks_.end(), cycle,
+                                         [](uint64_t c, const Block &block)
+                                         { return c < block.FirstCycle; });
+        return it == blocks_.begin() ? blocks_.size() : static_cast<size_t>(it - blocks_.begin() - 1);
+    }
+
+    const std::vector<TraceRecord> &TraceReader::decode(size_t block) const
+    {
+        if (block != cachedBlock_)
+        {
+            cachedRecords_.clear();
+            const auto offset = blocks_[block].Offset;
+            if (DecodeTraceBlock(data_ + offset, size_ - offset, cachedRecords_) == 0)
+            {
+                throw std::runtime_error("Trace block is corrupt");
+            }
+            cachedBlock_ = block;
+        }
+        return cachedRecords_;
+    }
+
+    bool TraceReader::Find(uint64_t cycle, TraceRecord &record) const
+    {
+        const auto block = findBlock(cycle);
+        if (block == blocks_.size())
+        {
+            return false;
+        }
+
+        const auto &records = decode(block);
+        const auto it = std::lower_bound(records.begin(), records.end(), cycle,
+                                         [](const TraceRecord &r, uint64_t c)
+                                         { return r.Cycle < c; });
+        if (it == records.end() || it->Cycle != cycle)
+        {
+            return false;
+        }
+
+        record = *it;
+        return true;
+    }
+
+    void TraceReader::ForEach(uint64_t from, uint64_t to, const std::function<bool(const TraceRecord &)> &visit) const
+    {
+        auto block = findBlock(from);
+        if (block == blocks_.size())
+        {
+            block = 0;
+        }
+
+        for (; block < blocks_.size() && blocks_[block].FirstCycle <= to; ++block)
+        {
+            // a copy, visit may look up other cycles and replace the cache
+            const auto records = decode(block);
+            for (const auto &record : records)
+            {
+                if (record.Cycle > to)
+                {
+                    return;
+                }
+                if (record.Cycle >= from && !visit(record))
+                {
+                    return;
+                }
+            }
+        }
+    }
+}
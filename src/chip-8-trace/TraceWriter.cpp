@@ -0,0 +1,179 @@
+#include "TraceWriter.h"
+
+#include <Utils/ByteOrder.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace SKChip8
+{
+    TraceWriter::TraceWriter(const std::string &path)
+        : file_(path, std::ios::out | std::ios::binary | std::ios::trunc),
+          submittedRecords_(0),
+          lastCycle_(0),
+          stopping_(false),
+          failed_(false),
+          closed_(false),
+          offset_(TRACE_FILE_HEADER_SIZE)
+    {
+        if (!file_.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        uint8_t header[TRACE_FILE_HEADER_SIZE];
+        std::memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        StoreLE(header + 4, TRACE_VERSION, 2);
+        StoreLE(header + 6, 0, 2);
+        file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        current_.reserve(BLOCK_RECORDS);
+        thread_ = std::thread(&TraceWriter::writerLoop, this);
+    }
+
+    TraceWriter::~TraceWriter()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const std::exception &)
+        {
+            // nothing sensible to do with a write error here
+        }
+    }
+
+    void TraceWriter::submit()
+    {
+        if (current_.empty())
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        pendingChanged_.wait(lock, [this]
+                             { return pending_.size() < MAX_PENDING_BLOCKS; });
+
+        submittedRecords_ += current_.size();
+        pending_.push_back(std::move(current_));
+
+        if (!free_.empty())
+        {
+            current_ = std::move(free_.back());
+            free_.pop_back();
+        }
+        else
+        {
+            current_ = std::vector<TraceRecord>();
+            current_.reserve(BLOCK_RECORDS);
+        }
+        current_.clear();
+
+        lock.unlock();
+        pendingChanged_.notify_all();
+    }
+
+    void TraceWriter::writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            pendingChanged_.wait(lock, [this]
+                                 { return stopping_ || !pending_.empty(); });
+            if (pending_.empty())
+            {
+                break;
+            }
+
+            auto block = std::move(pending_.front());
+            pending_.pop_front();
+            lock.unlock();
+            pendingChanged_.notify_all();
+
+            // encoding and the disk write happen without the lock held
+            encoded_.clear();
+            EncodeTraceBlock(block.data(), block.size(), encoded_);
+            file_.write(reinterpret_cast<const char *>(encoded_.data()), encoded_.size());
+            const bool ok = static_cast<bool>(file_);
+
+            lock.lock();
+            index_.push_back(IndexEntry{block.front().Cycle, offset_, static_cast<uint32_t>(block.size())});
+            offset_ += encoded_.size();
+            failed_ = failed_ || !ok;
+            block.clear();
+            free_.push_back(std::move(block));
+        }
+    }
+
+    uint64_t TraceWriter::GetBytesWritten() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return offset_;
+    }
+
+    void TraceWriter::Close()
+    {
+        if (closed_)
+        {
+            return;
+        }
+        closed_ = true;
+
+        submit();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        pendingChanged_.notify_all();
+        thread_.join();
+
+        std::vector<uint8_t> footer(index_.size() * TRACE_INDEX_ENTRY_SIZE + TRACE_FOOTER_SIZE);
+        auto out = footer.data();
+        for (const auto &entry : index_)
+        {
+            StoreLE(out, entry.FirstCycle, 8);
+            StoreLE(out + 8, entry.Offset, 8);
+            StoreLE(out + 16, entry.Records, 4);
+            out += TRACE_INDEX_ENTRY_SIZE;
+        }
+        StoreLE(out, offset_, 8);
+        StoreLE(out + 8, index_.size(), 4);
+        std::memcpy(out + 12, TRACE_INDEX_MAGIC, sizeof(TRACE_INDEX_MAGIC));
+
+        file_.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+        file_.close();
+        if (failed_ || !file_)
+        {
+            throw std::runtime_error("Failed writing trace");
+        }
+    }
+
+    void RunTraced(Emulator &emulator, uint64_t count, TraceWriter &writer)
+    {
+        const auto &cpu = emulator.GetCPU();
+        TraceRecord record;
+        auto registers = cpu.GetRegisters();
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            record.Cycle = cpu.GetCycleCount();
+            record.PC = cpu.GetPC();
+            record.Opcode = cpu.GetCurrentInstruction();
+
+            emulator.Step();
+
+            record.Registers = cpu.GetRegisters();
+            record.ChangedRegisters = 0;
+            for (size_t reg = 0; reg < REG_COUNT; ++reg)
+            {
+                if (record.Registers[reg] != registers[reg])
+                {
+                    record.ChangedRegisters |= 1 << reg;
+                }
+            }
+            registers = record.Registers;
+
+            writer.Append(record);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include "DeltaCodec.h"
+
+namespace
+{
+    static constexpr uint8_t ZERO_RUN_BIT = 0x80;
+    static constexpr size_t MAX_RUN = 0x80;
+}
+
+namespace SKChip8
+{
+    void EncodeXorDelta(const uint8_t *previous, const uint8_t *current, size_t size, std::vector<uint8_t> &out)
+    {
+        auto delta = [&](size_t i) -> uint8_t
+        {
+            return previous ? previous[i] ^ current[i] : current[i];
+        };
+
+        size_t i = 0;
+        while (i < size)
+        {
+            if (delta(i) == 0)
+            {
+                size_t run = 1;
+                while (i + run < size && run < MAX_RUN && delta(i + run) == 0)
+                {
+                    run++;
+                }
+                out.push_back(ZERO_RUN_BIT | static_cast<uint8_t>(run - 1));
+                i += run;
+                continue;
+            }
+
+            // a literal run ends at the first pair of zeros, a single zero is
+            // cheaper to carry along than to break the run for
+            size_t run = 1;
+            while (i + run < size && run < MAX_RUN &&
+                   !(delta(i + run) == 0 && (i + run + 1 >= size || delta(i + run + 1) == 0)))
+            {
+                run++;
+            }
+            out.push_back(static_cast<uint8_t>(run - 1));
+            for (size_t j = 0; j < run; ++j)
+            {
+                out.push_back(delta(i + j));
+            }
+            i += run;
+        }
+    }
+
+    size_t ApplyXorDelta(const uint8_t *encoded, size_t encodedSize, uint8_t *state, size_t size)
+    {
+        size_t in = 0;
+        size_t i = 0;
+        while (i < size)
+        {
+            if (in >= encodedSize)
+            {
+                return 0;
+            }
+
+            const auto control = encoded[in++];
+            const size_t run = (control & ~ZERO_RUN_BIT) + 1;
+            if (i + run > size)
+            {
+                return 0;
+            }
+
+            if (control & ZERO_RUN_BIT)
+            {
+                i += run;
+                continue;
+            }
+
+            if (in + run > encodedSize)
+            {
+                return 0;
+            }
+            for (size_t j = 0; j < run; ++j)
+            {
+                state[i + j] ^= encoded[in + j];
+            }
+            in += run;
+            i += run;
+        }
+
+        return in;
+    }
+}
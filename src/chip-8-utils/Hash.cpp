@@ -0,0 +1,79 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace
+{
+    static constexpr uint64_t K0 = 0x9E3779B97F4A7C15ull;
+    static constexpr uint64_t K1 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t K2 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t K3 = 0xD6E8FEB86659FD93ull;
+
+    inline uint64_t rotl(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // splitmix64 finalizer
+    inline uint64_t finalize(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    inline uint64_t readWord(const uint8_t *p)
+    {
+        uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    inline uint64_t readTail(const uint8_t *p, size_t n)
+    {
+        uint64_t w = 0;
+        std::memcpy(&w, p, n);
+        return w;
+    }
+}
+
+namespace SKChip8
+{
+    Hash128 HashBytes128(const void *data, size_t size, uint64_t seed)
+    {
+        auto bytes = static_cast<const uint8_t *>(data);
+        uint64_t a = seed ^ K0;
+        uint64_t b = rotl(seed, 32) ^ K1;
+
+        // two independent lanes so that the multiplies can overlap
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            auto w = readWord(bytes + i);
+            a = rotl(a ^ (w * K2), 31) * K0;
+            b = rotl(b ^ (w * K3), 27) * K1;
+        }
+
+        if (i < size)
+        {
+            auto w = readTail(bytes + i, size - i);
+            a = rotl(a ^ (w * K2), 31) * K0;
+            b = rotl(b ^ (w * K3), 27) * K1;
+        }
+
+        a ^= size;
+        b ^= size;
+        a += b;
+        b += a;
+
+        return Hash128{finalize(a), finalize(b)};
+    }
+
+    uint64_t HashBytes(const void *data, size_t size, uint64_t seed)
+    {
+        return HashBytes128(data, size, seed).Low;
+    }
+}
@@ -20,9 +20,20 @@ ROMLoader::ROMLoader(std::string filename)
         throw std::runtime_error("Could not open file: " + filename_);
     }
 
-    this->buffer_ = std::vector<uint8_t>(
-        std::istreambuf_iterator<char>(ifs),
-        std::istreambuf_iterator<char>());
+    // size the buffer up front and read it in one go
+    ifs.seekg(0, std::ios::end);
+    const auto size = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+    if (size < 0)
+    {
+        throw std::runtime_error("Could not read file: " + filename_);
+    }
+
+    this->buffer_.resize(static_cast<size_t>(size));
+    if (!ifs.read(reinterpret_cast<char *>(buffer_.data()), size))
+    {
+        throw std::runtime_error("Could not read file: " + filename_);
+    }
 }
 
 std::string ROMLoader::getDisassembly() const
@@ -54,7 +65,7 @@ std::string ROMLoader::getDisassembly() const
     return disassembly.str();
 }
 
-std::vector<uint8_t> ROMLoader::getROM() const
+const std::vector<uint8_t> &ROMLoader::getROM() const
 {
     return buffer_;
 }
@@ -0,0 +1,141 @@
+#include <SKChip8/Broadcast/BroadcastServer.h>
+#include <SKChip8/Emulator/Emulator.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// spectator mode. one process runs the emulator and broadcasts its screen:
+//   SKChip8EmuBroadcast serve ROM unix:/tmp/chip8.sock
+// and any number of viewers attach to it:
+//   SKChip8EmuBroadcast watch unix:/tmp/chip8.sock
+// tcp:PORT can be used instead of unix:PATH (bound to localhost)
+
+namespace
+{
+    static constexpr char RETURN_TO_TOP[] = "\033[H";
+
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " serve ROM (unix:PATH | tcp:PORT) [--keyframe FRAMES]\n"
+                  << "       " << name << " watch (unix:PATH | tcp:PORT) [--frames N]" << std::endl;
+    }
+
+    bool isTCP(const std::string &address) { return address.rfind("tcp:", 0) == 0; }
+    bool isUnix(const std::string &address) { return address.rfind("unix:", 0) == 0; }
+
+    int serve(const std::string &rom, const std::string &address, uint32_t keyframeInterval)
+    {
+        SKChip8::Emulator emulator;
+        emulator.LoadProgram(rom);
+
+        std::unique_ptr<SKChip8::BroadcastServer> server;
+        if (isTCP(address))
+        {
+            server = std::make_unique<SKChip8::BroadcastServer>(static_cast<uint16_t>(std::stoul(address.substr(4))));
+        }
+        else
+        {
+            server = std::make_unique<SKChip8::BroadcastServer>(address.substr(5));
+        }
+
+        SKChip8::FrameEncoder encoder(keyframeInterval);
+        const auto framePeriod = std::chrono::duration_cast<SKChip8::EmulatorDuration>(1s) / 60;
+        auto nextFrame = SKChip8::EmulatorClock::now();
+        double instructionCredit = 0.0;
+        size_t lastClientCount = 0;
+
+        while (true)
+        {
+            instructionCredit += SKChip8::EMULATOR_CPU_HZ / 60.0;
+            const auto instructions = static_cast<uint64_t>(instructionCredit);
+            instructionCredit -= instructions;
+            emulator.Run(instructions);
+
+            const auto message = encoder.Encode(emulator.GetCPU());
+            server->Publish(message, encoder.LastWasKeyframe());
+            server->Pump();
+
+            if (server->GetClientCount() != lastClientCount)
+            {
+                lastClientCount = server->GetClientCount();
+                std::cout << lastClientCount << " subscriber(s)" << std::endl;
+            }
+
+            nextFrame += framePeriod;
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    int watch(const std::string &address, uint64_t frames)
+    {
+        std::unique_ptr<SKChip8::BroadcastClient> client;
+        if (isTCP(address))
+        {
+            client = std::make_unique<SKChip8::BroadcastClient>("127.0.0.1", static_cast<uint16_t>(std::stoul(address.substr(4))));
+        }
+        else
+        {
+            client = std::make_unique<SKChip8::BroadcastClient>(address.substr(5));
+        }
+
+        SKChip8::FrameDecoder decoder;
+        for (uint64_t received = 0; frames == 0 || received < frames; ++received)
+        {
+            if (!client->Receive(decoder))
+            {
+                std::cerr << "Disconnected" << std::endl;
+                return 1;
+            }
+
+            if (!decoder.HasKeyframe())
+            {
+                continue;
+            }
+
+            std::string screen = RETURN_TO_TOP;
+            const auto &frame = decoder.GetPackedFrameBuffer();
+            for (size_t y = 0; y < SKChip8::SCR_HEIGHT; ++y)
+            {
+                for (size_t x = 0; x < SKChip8::SCR_WIDTH; ++x)
+                {
+                    screen += (frame[y * SKChip8::FRAME_ROW_BYTES + x / 8] >> (7 - x % 8)) & 1 ? '*' : ' ';
+                }
+                screen += '\n';
+            }
+            screen += "frame " + std::to_string(decoder.GetFrame()) + (decoder.GetSoundTimer() > 0 ? " [beep]" : "       ") + "\n";
+            std::cout << screen << std::flush;
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string mode = argc >= 2 ? argv[1] : "";
+
+    if (mode == "serve" && argc >= 4 && (isTCP(argv[3]) || isUnix(argv[3])))
+    {
+        uint32_t keyframeInterval = 60;
+        if (argc >= 6 && std::string(argv[4]) == "--keyframe")
+        {
+            keyframeInterval = static_cast<uint32_t>(std::stoul(argv[5]));
+        }
+        return serve(argv[2], argv[3], keyframeInterval);
+    }
+
+    if (mode == "watch" && argc >= 3 && (isTCP(argv[2]) || isUnix(argv[2])))
+    {
+        uint64_t frames = 0;
+        if (argc >= 5 && std::string(argv[3]) == "--frames")
+        {
+            frames = std::stoull(argv[4]);
+        }
+        return watch(argv[2], frames);
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
@@ -1,39 +1,154 @@
 #include <SKChip8/Emulator/Emulator.h>
+#include <SKChip8/Emulator/Movie.h>
+#include <SKChip8/Emulator/MovieIndex.h>
 
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 
 static constexpr char RETURN_TO_TOP[] = "\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r";
 
-int main(int argc, char *argv[])
+static void printFrame(const SKChip8::CPU::FrameBuffer &frame)
+{
+    for (size_t i = 0; i < frame.size(); ++i)
+    {
+        for (size_t j = 0; j < frame[i].size(); ++j)
+        {
+            if (frame[i][j])
+            {
+                std::cout << "*";
+            }
+            else
+            {
+                std::cout << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+// plays a movie back headless as fast as possible and checks it ends in the
+// recorded state
+static int replay(const char *rom, const char *moviePath, const char *profilePath, const char *callGraphPath)
 {
-    auto rom = argc < 2 ? "../roms/maze.ch8" : argv[1];
     SKChip8::Emulator emulator;
     emulator.LoadProgram(rom);
 
-    bool shouldStop = false;
-    while (!shouldStop)
+    SKChip8::MoviePlayer player(SKChip8::Movie::Load(moviePath));
+    player.Begin(emulator);
+
+    const auto start = std::chrono::steady_clock::now();
+    player.RunToEnd(emulator);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto &movie = player.GetMovie();
+    const auto stateHash = emulator.StateHash();
+    printFrame(emulator.GetFrameBuffer());
+
+    std::cout << "cycles: " << movie.Length << ", input events: " << movie.Events.size() << std::endl;
+    std::cout << "elapsed: " << elapsed << "s (" << (elapsed > 0 ? movie.Length / elapsed / 1e6 : 0) << " MIPS)" << std::endl;
+    std::cout << std::hex << std::setfill('0')
+              << "state: " << std::setw(16) << stateHash.High << std::setw(16) << stateHash.Low
+              << ", frame: " << std::setw(16) << SKChip8::FrameHash(emulator) << std::dec << std::endl;
+
+    if (profilePath || callGraphPath)
     {
-        emulator.Step();
-        auto frame = emulator.GetFrameBuffer();
+#ifdef SKCHIP8_PROFILING
+        if (profilePath)
+        {
+            std::ofstream csv(profilePath);
+            emulator.GetCPU().GetProfile().WriteCSV(csv);
+            std::cout << "profile written to " << profilePath << std::endl;
+        }
+        if (callGraphPath)
+        {
+            std::ofstream folded(callGraphPath);
+            emulator.GetCPU().GetCallGraph().WriteCollapsed(folded);
+            std::cout << "call graph written to " << callGraphPath << std::endl;
+        }
+#else
+        std::cout << "built without SKCHIP8_PROFILING, no profile written" << std::endl;
+#endif
+    }
+
+    if (!player.Verify(emulator))
+    {
+        std::cout << "replay DESYNCED from recording" << std::endl;
+        return 1;
+    }
+
+    std::cout << "replay matches recording" << std::endl;
+    return 0;
+}
 
-        for (size_t i = 0; i < frame.size(); ++i)
+// jumps to a cycle of a movie through its keyframe index, building the index
+// next to the movie on first use
+static int seek(const char *rom, const char *moviePath, uint64_t cycle)
+{
+    SKChip8::Emulator emulator;
+    emulator.LoadProgram(rom);
+
+    const auto movie = SKChip8::Movie::Load(moviePath);
+    auto start = std::chrono::steady_clock::now();
+    const auto index = SKChip8::MovieIndex::Open(moviePath, movie, emulator);
+    const auto openTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SKChip8::MoviePlayer player(movie);
+    player.Begin(emulator);
+
+    start = std::chrono::steady_clock::now();
+    index.Seek(player, emulator, cycle);
+    const auto seekTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printFrame(emulator.GetFrameBuffer());
+    std::cout << "cycle " << emulator.GetCycleCount() << " of " << movie.Length << std::endl;
+    std::cout << "index: " << index.GetKeyframeCount() << " keyframes, " << index.GetEncodedBytes()
+              << " bytes, opened in " << openTime << "s" << std::endl;
+    std::cout << "seek: " << seekTime * 1e3 << "ms" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    auto rom = argc < 2 ? "../roms/maze.ch8" : argv[1];
+
+    if (argc >= 6 && std::strcmp(argv[2], "--replay") == 0 && std::strcmp(argv[4], "--seek") == 0)
+    {
+        return seek(rom, argv[3], std::stoull(argv[5]));
+    }
+
+    if (argc >= 4 && std::strcmp(argv[2], "--replay") == 0)
+    {
+        const char *profilePath = nullptr;
+        const char *callGraphPath = nullptr;
+        for (int i = 4; i + 1 < argc; i += 2)
         {
-            for (size_t j = 0; j < frame[i].size(); ++j)
+            if (std::strcmp(argv[i], "--profile") == 0)
+            {
+                profilePath = argv[i + 1];
+            }
+            // collapsed stacks for flamegraph.pl
+            else if (std::strcmp(argv[i], "--callgraph") == 0)
             {
-                if (frame[i][j])
-                {
-                    std::cout << "*";
-                }
-                else
-                {
-                    std::cout << " ";
-                }
+                callGraphPath = argv[i + 1];
             }
-            std::cout << std::endl;
         }
+        return replay(rom, argv[3], profilePath, callGraphPath);
+    }
+
+    SKChip8::Emulator emulator;
+    emulator.LoadProgram(rom);
+
+    bool shouldStop = false;
+    while (!shouldStop)
+    {
+        emulator.Step();
+        printFrame(emulator.GetFrameBuffer());
 
         // return to the top
         std::cout << RETURN_TO_TOP;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,282 @@
+#include <SKChip8/Debug/DebugServer.h>
+#include <SKChip8/Emulator/Emulator.h>
+#include <SKChip8/Utils/ByteOrder.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// headless debug server. run the core with nothing but the socket:
+//   SKChip8EmuDebug serve SOCKET [ROM]
+// and drive it with a script read from stdin, sent as one pipelined batch:
+//   echo "run 100000
+//   regs" | SKChip8EmuDebug script SOCKET
+// script commands (addresses in hex, counts in decimal):
+//   hello | load PATH | reset | run N | step N | keys MASK
+//   break ADDR [CONDITION] | unbreak ADDR | watch ADDR SIZE r|w|rw | clear
+//   mem ADDR SIZE | regs | frame | save FILE | restore FILE
+// load and restore read their file while the script is parsed, before anything is sent
+
+namespace
+{
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " serve SOCKET [ROM]\n"
+                  << "       " << name << " script SOCKET < COMMANDS" << std::endl;
+    }
+
+    int serve(const std::string &path, const char *rom)
+    {
+        SKChip8::Emulator emulator;
+        if (rom)
+        {
+            emulator.LoadProgram(rom);
+        }
+
+        SKChip8::BreakpointSet breakpoints;
+        SKChip8::EmulatorDebugTarget target(emulator, breakpoints);
+        SKChip8::DebugServer server(path, target);
+        std::cout << "listening on " << path << std::endl;
+
+        size_t lastClientCount = 0;
+        while (true)
+        {
+            server.Pump(-1);
+            if (server.GetClientCount() != lastClientCount)
+            {
+                lastClientCount = server.GetClientCount();
+                std::cout << lastClientCount << " client(s)" << std::endl;
+            }
+        }
+    }
+
+    std::vector<uint8_t> le(uint64_t value, size_t bytes)
+    {
+        std::vector<uint8_t> out(bytes);
+        SKChip8::StoreLE(out.data(), value, bytes);
+        return out;
+    }
+
+    uint16_t hex(const std::string &text) { return static_cast<uint16_t>(std::stoul(text, nullptr, 16)); }
+
+    // what to do with a response once the batch comes back
+    struct Pending
+    {
+        std::string Line;
+        std::string File;
+    };
+
+    void printResponse(const Pending &pending, const SKChip8::DebugClient::Response &response)
+    {
+        using SKChip8::DebugCommand;
+        const auto &payload = response.Payload;
+
+        if (!response.Ok())
+        {
+            std::cout << pending.Line << ": error: " << response.Error() << std::endl;
+            return;
+        }
+
+        switch (response.Command)
+        {
+        case DebugCommand::Hello:
+            std::cout << std::string(payload.begin(), payload.begin() + 4) << " version "
+                      << SKChip8::LoadLE(payload.data() + 4, 2) << std::endl;
+            break;
+        case DebugCommand::Run:
+            std::cout << pending.Line << ": " << SKChip8::LoadLE(payload.data(), 8) << " executed"
+                      << (payload[8] ? ", stopped at a breakpoint" : "") << std::endl;
+            break;
+        case DebugCommand::ReadMemory:
+            for (size_t i = 0; i < payload.size(); ++i)
+            {
+                std::cout << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << int(payload[i])
+                          << (i % 16 == 15 || i + 1 == payload.size() ? "\n" : " ");
+            }
+            std::cout << std::dec << std::setfill(' ');
+            break;
+        case DebugCommand::ReadRegisters:
+        {
+            std::cout << std::hex << std::uppercase << std::setfill('0')
+                      << "PC " << std::setw(3) << SKChip8::LoadLE(payload.data(), 2)
+                      << " I " << std::setw(3) << SKChip8::LoadLE(payload.data() + 2, 2);
+            for (size_t reg = 0; reg < SKChip8::REG_COUNT; ++reg)
+            {
+                std::cout << " V" << reg << " " << std::setw(2) << int(payload[4 + reg]);
+            }
+            std::cout << " DT " << std::setw(2) << int(payload[20]) << " ST " << std::setw(2) << int(payload[21])
+                      << std::dec << std::setfill(' ') << " cycle " << SKChip8::LoadLE(payload.data() + 22, 8) << std::endl;
+            break;
+        }
+        case DebugCommand::ReadFrame:
+            for (size_t y = 0; y < SKChip8::SCR_HEIGHT; ++y)
+            {
+                std::string row;
+                for (size_t x = 0; x < SKChip8::SCR_WIDTH; ++x)
+                {
+                    row += (payload[y * (SKChip8::SCR_WIDTH / 8) + x / 8] >> (7 - x % 8)) & 1 ? '*' : ' ';
+                }
+                std::cout << row << "\n";
+            }
+            break;
+        case DebugCommand::SaveState:
+        {
+            std::ofstream out(pending.File, std::ios::binary);
+            out.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+            std::cout << pending.Line << ": " << payload.size() << " bytes" << std::endl;
+            break;
+        }
+        default:
+            std::cout << pending.Line << ": ok" << std::endl;
+            break;
+        }
+    }
+
+    int script(const std::string &path)
+    {
+        using SKChip8::DebugCommand;
+
+        SKChip8::DebugClient client(path);
+        std::vector<Pending> pending;
+
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            std::istringstream ss(line);
+            std::string command;
+            if (!(ss >> command) || command[0] == '#')
+            {
+                continue;
+            }
+
+            std::vector<std::string> args{std::istream_iterator<std::string>(ss), std::istream_iterator<std::string>()};
+            Pending entry{line, ""};
+            try
+            {
+                if (command == "hello")
+                {
+                    client.Send(DebugCommand::Hello);
+                }
+                else if (command == "load" && args.size() == 1)
+                {
+                    client.Send(DebugCommand::LoadROM, std::vector<uint8_t>(args[0].begin(), args[0].end()));
+                }
+                else if (command == "reset")
+                {
+                    client.Send(DebugCommand::Reset);
+                }
+                else if ((command == "run" || command == "step") && args.size() == 1)
+                {
+                    client.Send(command == "run" ? DebugCommand::Run : DebugCommand::Step, le(std::stoull(args[0]), 8));
+                }
+                else if (command == "keys" && args.size() == 1)
+                {
+                    client.Send(DebugCommand::SetKeys, le(hex(args[0]), 2));
+                }
+                else if (command == "break" && !args.empty())
+                {
+                    // everything after the address is the condition, read from
+                    // the line itself to keep its spacing
+                    std::istringstream breakLine(line);
+                    std::string address, condition;
+                    breakLine >> command >> address;
+                    std::getline(breakLine, condition);
+
+                    auto payload = le(hex(address), 2);
+                    if (args.size() > 1)
+                    {
+                        payload.insert(payload.end(), condition.begin(), condition.end());
+                    }
+                    client.Send(DebugCommand::AddBreakpoint, payload);
+                }
+                else if (command == "unbreak" && args.size() == 1)
+                {
+                    client.Send(DebugCommand::RemoveBreakpoint, le(hex(args[0]), 2));
+                }
+                else if (command == "watch" && args.size() == 3)
+                {
+                    auto payload = le(hex(args[0]), 2);
+                    const auto size = le(std::stoul(args[1]), 2);
+                    payload.insert(payload.end(), size.begin(), size.end());
+                    payload.push_back(args[2].find('r') != std::string::npos);
+                    payload.push_back(args[2].find('w') != std::string::npos);
+                    client.Send(DebugCommand::AddWatchpoint, payload);
+                }
+                else if (command == "clear")
+                {
+                    client.Send(DebugCommand::ClearBreakpoints);
+                }
+                else if (command == "mem" && args.size() == 2)
+                {
+                    auto payload = le(hex(args[0]), 2);
+                    const auto size = le(std::stoul(args[1]), 2);
+                    payload.insert(payload.end(), size.begin(), size.end());
+                    client.Send(DebugCommand::ReadMemory, payload);
+                }
+                else if (command == "regs")
+                {
+                    client.Send(DebugCommand::ReadRegisters);
+                }
+                else if (command == "frame")
+                {
+                    client.Send(DebugCommand::ReadFrame);
+                }
+                else if (command == "save" && args.size() == 1)
+                {
+                    entry.File = args[0];
+                    client.Send(DebugCommand::SaveState);
+                }
+                else if (command == "restore" && args.size() == 1)
+                {
+                    std::ifstream in(args[0], std::ios::binary);
+                    client.Send(DebugCommand::LoadState, std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {}));
+                }
+                else
+                {
+                    std::cerr << "unknown command: " << line << std::endl;
+                    continue;
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << line << ": " << e.what() << std::endl;
+                continue;
+            }
+            pending.push_back(entry);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto responses = client.Flush();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t i = 0; i < responses.size(); ++i)
+        {
+            printResponse(pending[i], responses[i]);
+        }
+        std::cerr << responses.size() << " requests in one round trip, " << elapsed * 1e3 << "ms" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string mode = argc >= 2 ? argv[1] : "";
+
+    if (mode == "serve" && argc >= 3)
+    {
+        return serve(argv[2], argc >= 4 ? argv[3] : nullptr);
+    }
+
+    if (mode == "script" && argc >= 3)
+    {
+        return script(argv[2]);
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,169 @@
+#include <SKChip8/Emulator/DivergenceFinder.h>
+#include <SKChip8/Utils/CHIP8ISA.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// runs two execution engines side by side and reports the first instruction
+// they disagree on:
+//   SKChip8EmuDiverge ROM MOVIE [--engines A,B] [--interval N]
+//   SKChip8EmuDiverge ROM --instructions N [--engines A,B] [--interval N]
+// engines: step (the reference, one CPU::Cycle at a time), run (batched)
+
+namespace
+{
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " ROM (MOVIE | --instructions N) [--engines A,B] [--interval N]\n"
+                  << "engines: step, run" << std::endl;
+    }
+
+    SKChip8::ExecutionEngine engineByName(const std::string &name)
+    {
+        if (name == "step")
+        {
+            return SKChip8::ReferenceEngine();
+        }
+        if (name == "run")
+        {
+            return SKChip8::BatchedEngine();
+        }
+        throw std::invalid_argument("Unknown engine: " + name);
+    }
+
+    void printState(const std::string &label, const SKChip8::Emulator::SaveStateBuffer &state, const SKChip8::Emulator &romSource)
+    {
+        auto emulator = romSource.Clone();
+        emulator->LoadState(state);
+        const auto &cpu = emulator->GetCPU();
+
+        std::stringstream instruction;
+        SKChip8::DecodeInstruction(cpu.GetCurrentInstruction())->dump(instruction);
+
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-8s cycle %llu  PC %03X  I %03X  DT %02X  ST %02X  next: ",
+                      label.c_str(), static_cast<unsigned long long>(cpu.GetCycleCount()),
+                      cpu.GetPC(), cpu.GetIndexPointer(), cpu.GetDelayTimer(), cpu.GetSoundTimer());
+        std::cout << line << instruction.str() << "\n         ";
+
+        const auto registers = cpu.GetRegisters();
+        for (size_t reg = 0; reg < registers.size(); ++reg)
+        {
+            std::snprintf(line, sizeof(line), "V%zX %02X ", reg, registers[reg]);
+            std::cout << line;
+        }
+        std::cout << std::endl;
+    }
+
+    void printDifferences(const SKChip8::Emulator::SaveStateBuffer &a, const SKChip8::Emulator::SaveStateBuffer &b, const SKChip8::Emulator &romSource)
+    {
+        auto emulatorA = romSource.Clone();
+        auto emulatorB = romSource.Clone();
+        emulatorA->LoadState(a);
+        emulatorB->LoadState(b);
+
+        const auto memoryA = emulatorA->GetCPU().GetMemory();
+        const auto memoryB = emulatorB->GetCPU().GetMemory();
+        size_t shown = 0;
+        for (size_t addr = 0; addr < memoryA.size(); ++addr)
+        {
+            if (memoryA[addr] != memoryB[addr] && shown++ < 16)
+            {
+                char line[64];
+                std::snprintf(line, sizeof(line), "memory %03zX: %02X vs %02X", addr, memoryA[addr], memoryB[addr]);
+                std::cout << line << std::endl;
+            }
+        }
+
+        const auto &frameA = emulatorA->GetCPU().GetPackedFrameBuffer();
+        const auto &frameB = emulatorB->GetCPU().GetPackedFrameBuffer();
+        size_t frameBytes = 0;
+        for (size_t i = 0; i < frameA.size(); ++i)
+        {
+            frameBytes += frameA[i] != frameB[i];
+        }
+        if (frameBytes > 0)
+        {
+            std::cout << "framebuffer: " << frameBytes << " bytes differ" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string engines = "step,run";
+    uint64_t interval = 4096;
+    uint64_t instructions = 0;
+    std::string moviePath;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--engines") == 0 && i + 1 < argc)
+        {
+            engines = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+        {
+            interval = std::stoull(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--instructions") == 0 && i + 1 < argc)
+        {
+            instructions = std::stoull(argv[++i]);
+        }
+        else
+        {
+            moviePath = argv[i];
+        }
+    }
+
+    const auto comma = engines.find(',');
+    if (comma == std::string::npos || (moviePath.empty() && instructions == 0))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    SKChip8::Emulator a;
+    SKChip8::Emulator b;
+    a.LoadProgram(argv[1]);
+    b.LoadProgram(argv[1]);
+
+    SKChip8::Movie movie;
+    if (!moviePath.empty())
+    {
+        movie = SKChip8::Movie::Load(moviePath);
+    }
+    else
+    {
+        // no input at all
+        movie.ROMHash = a.GetROMHash();
+        movie.Seed = 1;
+        movie.Length = instructions;
+    }
+
+    SKChip8::DivergenceFinder finder(engineByName(engines.substr(0, comma)), engineByName(engines.substr(comma + 1)), interval);
+    const auto report = finder.Run(movie, a, b);
+
+    const auto &nameA = finder.GetEngineA().Name;
+    const auto &nameB = finder.GetEngineB().Name;
+    if (!report.Diverged)
+    {
+        std::cout << nameA << " and " << nameB << " agree for all " << report.MatchingCycles << " instructions" << std::endl;
+        return 0;
+    }
+
+    std::cout << nameA << " and " << nameB << " diverge at instruction " << report.MatchingCycles << std::endl;
+    printState("before", report.Before, a);
+    printState(nameA, report.AfterA, a);
+    printState(nameB, report.AfterB, a);
+    printDifferences(report.AfterA, report.AfterB, a);
+    return 1;
+}
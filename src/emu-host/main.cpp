@@ -0,0 +1,58 @@
+#include <SKChip8/Host/SessionHost.h>
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " ROM [sessions] [threads] [seconds]" << std::endl;
+        return 1;
+    }
+
+    const std::string rom = argv[1];
+    const size_t sessionCount = argc >= 3 ? std::stoul(argv[2]) : 1000;
+    const size_t threadCount = argc >= 4 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    const size_t seconds = argc >= 5 ? std::stoul(argv[4]) : 10;
+
+    SKChip8::Emulator prototype;
+    prototype.LoadProgram(rom);
+
+    SKChip8::SessionHost host(threadCount);
+    for (size_t i = 0; i < sessionCount; ++i)
+    {
+        host.AddSession(prototype.Clone());
+    }
+
+    std::cout << "Running " << sessionCount << " sessions on " << threadCount << " threads" << std::endl;
+    host.Start();
+    for (size_t s = 0; s < seconds; ++s)
+    {
+        std::this_thread::sleep_for(1s);
+
+        double worstMax = 0.0;
+        double meanSum = 0.0;
+        for (SKChip8::SessionHost::SessionId id = 0; id < host.GetSessionCount(); ++id)
+        {
+            auto stats = host.GetSessionStats(id);
+            worstMax = std::max(worstMax, stats.MaxLatenessMs);
+            meanSum += stats.MeanLatenessMs;
+        }
+
+        std::cout << "[" << s + 1 << "s] cpu: " << host.GetCPUUsage()
+                  << " cores, mean lateness: " << meanSum / sessionCount
+                  << "ms, worst lateness: " << worstMax << "ms" << std::endl;
+    }
+    host.Stop();
+
+    for (SKChip8::SessionHost::SessionId id = 0; id < std::min<size_t>(host.GetSessionCount(), 8); ++id)
+    {
+        auto stats = host.GetSessionStats(id);
+        std::cout << "session " << id << ": " << stats.Frames << " frames, mean lateness "
+                  << stats.MeanLatenessMs << "ms, max lateness " << stats.MaxLatenessMs << "ms" << std::endl;
+    }
+
+    return 0;
+}
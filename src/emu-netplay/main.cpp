@@ -0,0 +1,228 @@
+#include <SKChip8/Netplay/RollbackSession.h>
+#include <SKChip8/Netplay/UDPSocket.h>
+#include <SKChip8/Utils/ByteOrder.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// headless rollback netplay peer. run one process per player, e.g.
+//   SKChip8EmuNetplay pong.ch8 0 7000 127.0.0.1:7001
+//   SKChip8EmuNetplay pong.ch8 1 7001 127.0.0.1:7000
+// local input is scripted from the player index so runs are reproducible,
+// and peers exchange confirmed state hashes to detect desyncs
+
+namespace
+{
+    static constexpr uint8_t PACKET_MAGIC[2] = {'C', '8'};
+    // every packet repeats this many recent frames of input to cover losses
+    static constexpr uint32_t INPUT_REDUNDANCY = 16;
+    static constexpr size_t HEADER_SIZE = 2 + 1 + 1 + 4 + 4 + 8;
+    static constexpr size_t MAX_PACKET_SIZE = HEADER_SIZE + 2 * INPUT_REDUNDANCY;
+
+    struct Packet
+    {
+        uint8_t Player;
+        uint32_t FirstFrame;
+        uint32_t HashFrame;
+        uint64_t Hash;
+        std::vector<uint16_t> Inputs;
+    };
+
+    size_t encodePacket(const SKChip8::RollbackSession &session, uint8_t *out)
+    {
+        const auto player = session.GetLocalPlayer();
+        const auto count = session.GetInputCount(player);
+        const auto first = count > INPUT_REDUNDANCY ? count - INPUT_REDUNDANCY : 0;
+
+        const auto hashFrame = session.GetLastHashedFrame();
+        uint64_t hash = 0;
+        session.GetConfirmedHash(hashFrame, hash);
+
+        out[0] = PACKET_MAGIC[0];
+        out[1] = PACKET_MAGIC[1];
+        out[2] = player;
+        out[3] = static_cast<uint8_t>(count - first);
+        SKChip8::StoreLE(out + 4, first, 4);
+        SKChip8::StoreLE(out + 8, hashFrame, 4);
+        SKChip8::StoreLE(out + 12, hash, 8);
+
+        auto cursor = out + HEADER_SIZE;
+        for (auto frame = first; frame < count; ++frame, cursor += 2)
+        {
+            SKChip8::StoreLE(cursor, session.GetInput(player, frame), 2);
+        }
+        return cursor - out;
+    }
+
+    bool decodePacket(const uint8_t *in, size_t size, Packet &packet)
+    {
+        if (size < HEADER_SIZE || in[0] != PACKET_MAGIC[0] || in[1] != PACKET_MAGIC[1])
+        {
+            return false;
+        }
+
+        const size_t count = in[3];
+        if (size != HEADER_SIZE + 2 * count)
+        {
+            return false;
+        }
+
+        packet.Player = in[2];
+        packet.FirstFrame = static_cast<uint32_t>(SKChip8::LoadLE(in + 4, 4));
+        packet.HashFrame = static_cast<uint32_t>(SKChip8::LoadLE(in + 8, 4));
+        packet.Hash = SKChip8::LoadLE(in + 12, 8);
+        packet.Inputs.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            packet.Inputs[i] = static_cast<uint16_t>(SKChip8::LoadLE(in + HEADER_SIZE + 2 * i, 2));
+        }
+        return true;
+    }
+
+    // holds a pseudo-random key for half a second at a time
+    uint16_t scriptedInput(uint8_t player, uint32_t frame)
+    {
+        uint32_t x = (player + 1) * 0x9E3779B9u ^ (frame / 30 + 1) * 0x85EBCA6Bu;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return (x & 0x10) ? (1 << (x & 0xF)) : 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 5)
+    {
+        std::cout << "Usage: " << argv[0] << " ROM PLAYER PORT PEER_HOST:PORT [PEER_HOST:PORT...] [--frames N] [--seed S]" << std::endl;
+        return 1;
+    }
+
+    const std::string rom = argv[1];
+    const auto localPlayer = static_cast<uint8_t>(std::stoul(argv[2]));
+    const auto port = static_cast<uint16_t>(std::stoul(argv[3]));
+
+    std::vector<SKChip8::UDPSocket::Endpoint> peers;
+    uint32_t targetFrames = 600;
+    uint32_t seed = 0xC8C8C8C8;
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+        {
+            targetFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else
+        {
+            peers.push_back(SKChip8::UDPSocket::ParseEndpoint(arg));
+        }
+    }
+
+    SKChip8::Emulator initial;
+    initial.LoadProgram(rom);
+    initial.SeedRandom(seed);
+
+    SKChip8::RollbackSession session(initial, static_cast<uint8_t>(peers.size() + 1), localPlayer);
+    SKChip8::UDPSocket socket(port);
+
+    std::array<uint8_t, MAX_PACKET_SIZE> buffer;
+    Packet packet;
+    uint64_t desyncs = 0;
+    uint64_t stalls = 0;
+    double worstAdvanceMs = 0.0;
+
+    const auto frameBudget = std::chrono::duration_cast<SKChip8::EmulatorDuration>(
+        std::chrono::duration<double>(1.0 / SKChip8::RollbackSession::FRAME_HZ));
+    auto nextFrame = SKChip8::EmulatorClock::now();
+    const auto giveUp = [&]
+    { return SKChip8::EmulatorClock::now() - nextFrame > 5s; };
+
+    // keep exchanging packets after the last frame until every peer has
+    // confirmed it, so that the final hashes can be compared
+    while (session.GetConfirmedFrame() < targetFrames)
+    {
+        while (auto size = socket.Receive(buffer.data(), buffer.size()))
+        {
+            if (!decodePacket(buffer.data(), size, packet))
+            {
+                continue;
+            }
+
+            for (size_t i = 0; i < packet.Inputs.size(); ++i)
+            {
+                session.AddRemoteInput(packet.Player, packet.FirstFrame + static_cast<uint32_t>(i), packet.Inputs[i]);
+            }
+
+            uint64_t localHash;
+            if (session.GetConfirmedHash(packet.HashFrame, localHash) && localHash != packet.Hash)
+            {
+                desyncs++;
+                std::cerr << "Desync with player " << int(packet.Player) << " at frame " << packet.HashFrame << std::endl;
+            }
+        }
+        session.ApplyRollback();
+
+        if (session.GetFrame() < targetFrames)
+        {
+            const auto start = SKChip8::EmulatorClock::now();
+            if (session.AdvanceFrame(scriptedInput(localPlayer, session.GetFrame())))
+            {
+                const auto elapsed = std::chrono::duration<double, std::milli>(SKChip8::EmulatorClock::now() - start).count();
+                worstAdvanceMs = std::max(worstAdvanceMs, elapsed);
+            }
+            else
+            {
+                stalls++;
+            }
+
+            if (session.GetFrame() % 60 == 0)
+            {
+                uint64_t hash = 0;
+                session.GetConfirmedHash(session.GetLastHashedFrame(), hash);
+                std::cout << "frame " << session.GetFrame()
+                          << " confirmed " << session.GetConfirmedFrame()
+                          << " rollbacks " << session.GetRollbackCount()
+                          << " max resim " << session.GetMaxResimulatedFrames()
+                          << " hash[" << session.GetLastHashedFrame() << "] "
+                          << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::endl;
+            }
+        }
+        else if (giveUp())
+        {
+            std::cerr << "Timed out waiting for peers" << std::endl;
+            return 1;
+        }
+
+        const auto size = encodePacket(session, buffer.data());
+        for (const auto &peer : peers)
+        {
+            socket.SendTo(peer, buffer.data(), size);
+        }
+
+        if (session.GetFrame() < targetFrames)
+        {
+            nextFrame += frameBudget;
+        }
+        std::this_thread::sleep_until(std::max(nextFrame, SKChip8::EmulatorClock::now() + 1ms));
+    }
+
+    uint64_t finalHash = 0;
+    session.GetConfirmedHash(targetFrames, finalHash);
+    std::cout << "final hash[" << targetFrames << "] " << std::hex << std::setw(16) << std::setfill('0') << finalHash << std::dec
+              << " rollbacks " << session.GetRollbackCount()
+              << " stalls " << stalls
+              << " worst frame " << worstAdvanceMs << "ms"
+              << " desyncs " << desyncs << std::endl;
+
+    return desyncs == 0 ? 0 : 2;
+}
@@ -3,7 +3,13 @@
 
 #include <Utils/CHIP8Utils.h>
 #include <Utils/CHIP8ISA.h>
+#include <Emulator/Disassembly.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <vector>
 #include <cstdint>
 #include <memory>
@@ -33,10 +39,19 @@ public:
 protected:
     void initializeWindow();
     void destroyWindow();
-    void drawStateInfoPane();
-    void drawMemoryPane();
+    void drawStateInfoPane(const SKChip8::StateSnapshot &snapshot);
+    void drawMemoryPane(const SKChip8::StateSnapshot &snapshot);
+    void drawDisassemblyPane(const SKChip8::StateSnapshot &snapshot);
     void drawEmulatorInfoPane();
+    void drawMemoryHeatmapPane();
+    void drawProfilerPane();
+#ifdef SKCHIP8_PROFILING
+    void drawCallGraphTable();
+#endif
     void drawControlPane();
+    void drawRewindControls();
+    void drawReverseStepControls();
+    void drawBreakpointPane();
 
 private:
     std::shared_ptr<SDLEmuAdapter> emulator_;
@@ -44,12 +59,57 @@ private:
     SDL_GLContext glContext_;
     ImGuiContext *imGuiContext_;
     bool display_;
+
+    // quick save slot for the Save/Load State buttons
+    SKChip8::Emulator::SaveStateBuffer quickSave_;
+    bool hasQuickSave_;
+
+    // how many frames back the rewind slider currently shows, 0 is live
+    int rewindPosition_;
+
+    // hex address Reverse Continue stops at
+    char reverseTarget_[5];
+
+    // new breakpoint fields, the condition is optional
+    char breakpointAddress_[5];
+    char breakpointCondition_[32];
+    std::string breakpointError_;
+
+    // new watchpoint fields
+    char watchAddress_[5];
+    int watchSize_;
+    bool watchRead_;
+    bool watchWrite_;
+
+    // the heatmap pane scrolls this to the clicked address
+    MemoryEditor memoryEditor_;
+
+    // disassembly of the latest snapshot's memory, only changed bytes are redone
+    SKChip8::DisassemblyCache disassembly_;
+    // keep PC centered in the disassembly pane, scrolling only when PC moves
+    bool followPC_;
+    uint16_t disassemblyPC_;
+
+    // profiler table shows opcode classes (0), program addresses (1) or subroutines (2)
+    int profilerView_;
 };
 
 DebuggingWindow::DebuggingWindow(std::shared_ptr<SDLEmuAdapter> emulator)
 {
     emulator_ = emulator;
     display_ = true;
+    hasQuickSave_ = false;
+    rewindPosition_ = 0;
+    profilerView_ = 0;
+    followPC_ = true;
+    disassemblyPC_ = 0;
+    std::snprintf(reverseTarget_, sizeof(reverseTarget_), "%03X", SKChip8::PROG_MEMORY_OFFSET);
+    std::snprintf(breakpointAddress_, sizeof(breakpointAddress_), "%03X", SKChip8::PROG_MEMORY_OFFSET);
+    breakpointCondition_[0] = '\0';
+    std::snprintf(watchAddress_, sizeof(watchAddress_), "%03X", SKChip8::PROG_MEMORY_OFFSET);
+    watchSize_ = 1;
+    watchRead_ = false;
+    watchWrite_ = true;
     initializeWindow();
 }
 
@@ -73,6 +133,8 @@ void DebuggingWindow::Update()
     if (!display_)
         return;
 
+    EventTracer::Span span("DebuggingWindow::Update");
+
     // init
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(window_);
@@ -80,10 +142,18 @@ void DebuggingWindow::Update()
 
     // draw panes
     {
-        drawStateInfoPane();
-        drawMemoryPane();
+        // every pane shows the same instant, without copying it
+        const auto snapshot = emulator_->AcquireSnapshot();
+        disassembly_.Update(snapshot->Memory);
+
+        drawStateInfoPane(*snapshot);
+        drawMemoryPane(*snapshot);
+        drawDisassemblyPane(*snapshot);
+        drawMemoryHeatmapPane();
         drawControlPane();
+        drawBreakpointPane();
         drawEmulatorInfoPane();
+        drawProfilerPane();
     }
 
     // render it
@@ -96,7 +166,7 @@ void DebuggingWindow::Update()
     SDL_GL_SwapWindow(window_);
 }
 
-void DebuggingWindow::drawStateInfoPane()
+void DebuggingWindow::drawStateInfoPane(const SKChip8::StateSnapshot &snapshot)
 {
     static int keymap[] = {
         1, 2, 3, 0xC,
@@ -105,32 +175,30 @@ void DebuggingWindow::drawStateInfoPane()
         0xA, 0, 0xB, 0xF};
 
     ImGui::Begin("State Info");
-    const auto &cpu = emulator_->GetCPU();
-    std::stringstream instructionStringStream;
-    SKChip8::DecodeInstruction(cpu->GetCurrentInstruction())->dump(instructionStringStream);
 
-    ImGui::Text("PC: %04X", cpu->GetPC(), instructionStringStream.str().c_str());
-    ImGui::TextColored(ImVec4(0.090f, 0.929f, 0.933f, 1.0f), "%s\n\n", instructionStringStream.str().c_str());
+    ImGui::Text("Cycle: %llu", static_cast<unsigned long long>(snapshot.CycleCount));
+    ImGui::Text("PC: %04X", snapshot.PC);
+    ImGui::TextColored(ImVec4(0.090f, 0.929f, 0.933f, 1.0f), "%s\n\n", disassembly_.At(snapshot.PC).Text);
 
-    ImGui::Text("I: %04X", cpu->GetIndexPointer());
+    ImGui::Text("I: %04X", snapshot.IndexPointer);
     // TODO(sk00): add address register, maybe the 5-byte sprite pointed to by I, and timer values
 
     // print registers inline
-    auto registers = cpu->GetRegisters();
+    const auto &registers = snapshot.Registers;
     ImGui::Text("V0: %02X V1: %02X V2: %02X V3: %02X V4: %02X V5: %02X V6: %02X V7: %02X",
                 registers[0], registers[1], registers[2], registers[3], registers[4], registers[5], registers[6], registers[7]);
     ImGui::Text("V8: %02X V9: %02X VA: %02X VB: %02X VC: %02X VD: %02X VE: %02X VF: %02X",
                 registers[8], registers[9], registers[10], registers[11], registers[12], registers[13], registers[14], registers[15]);
 
     // print timers
-    auto delaytimer = cpu->GetDelayTimer();
-    auto soundtimer = cpu->GetSoundTimer();
+    auto delaytimer = snapshot.DelayTimer;
+    auto soundtimer = snapshot.SoundTimer;
     ImGui::Text("Delay Timer: %02X", delaytimer);
     ImGui::SameLine();
     ImGui::Text("Sound Timer: %02X", soundtimer);
 
     // print keyboard state
-    auto keyboardState = cpu->GetKeyState();
+    const auto &keyboardState = snapshot.KeyState;
     ImGui::Text("Keyboard State:");
     std::stringstream keyboardStateStream;
     for (int i = 0; i < 16; ++i)
@@ -144,15 +212,141 @@ void DebuggingWindow::drawStateInfoPane()
     ImGui::End();
 }
 
-void DebuggingWindow::drawMemoryPane()
+void DebuggingWindow::drawMemoryPane(const SKChip8::StateSnapshot &snapshot)
+{
+    memoryEditor_.ReadOnly = true;
+
+    // the editor only reads through the pointer while ReadOnly is set
+    auto &memory = snapshot.Memory;
+    memoryEditor_.DrawWindow("Memory Viewer", const_cast<uint8_t *>(memory.data()), memory.size());
+}
+
+void DebuggingWindow::drawDisassemblyPane(const SKChip8::StateSnapshot &snapshot)
+{
+    ImGui::Begin("Disassembly");
+
+    ImGui::Checkbox("Follow PC", &followPC_);
+    ImGui::SameLine();
+    ImGui::TextUnformatted("click a line to toggle a breakpoint");
+
+    // rows step by two from PC's alignment, so data read at the wrong
+    // alignment shows up as what the CPU will actually execute
+    const uint16_t alignment = snapshot.PC & 1;
+    const int rows = (SKChip8::CHIP8_MEM_SIZE - alignment) / 2;
+    auto &breakpoints = emulator_->GetBreakpoints();
+
+    ImGui::BeginChild("Lines", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    if (followPC_ && snapshot.PC != disassemblyPC_)
+    {
+        const float pcOffset = (snapshot.PC / 2) * rowHeight;
+        ImGui::SetScrollY(std::max(0.0f, pcOffset - ImGui::GetContentRegionAvail().y / 2));
+        disassemblyPC_ = snapshot.PC;
+    }
+
+    // only the visible rows are submitted, so all of memory costs a screenful
+    ImGuiListClipper clipper;
+    clipper.Begin(rows, rowHeight);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+        {
+            const auto address = static_cast<uint16_t>(alignment + row * 2);
+            const auto &line = disassembly_.At(address);
+            const bool breakpoint = breakpoints.IsSet(address);
+
+            char label[64];
+            std::snprintf(label, sizeof(label), "%c %03X  %04X  %s", breakpoint ? '*' : ' ', address, line.Opcode, line.Text);
+
+            ImGui::PushID(address);
+            if (ImGui::Selectable(label, address == snapshot.PC))
+            {
+                if (breakpoint)
+                {
+                    breakpoints.Remove(address);
+                }
+                else
+                {
+                    breakpoints.Add(address);
+                }
+            }
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+void DebuggingWindow::drawMemoryHeatmapPane()
 {
-    static MemoryEditor memoryEditor;
-    memoryEditor.ReadOnly = true;
+    ImGui::Begin("Memory Heatmap");
+
+#ifdef SKCHIP8_PROFILING
+    static constexpr size_t COLUMNS = 64;
+    static constexpr float CELL_SIZE = 6.0f;
+
+    const auto &heatmap = emulator_->GetCPU().GetHeatmap();
+
+    // log scale against the hottest address of each kind, so that a tight
+    // loop doesn't wash out everything else
+    uint32_t maxCount[3] = {1, 1, 1};
+    size_t selfModifying = 0;
+    for (size_t address = 0; address < SKChip8::HEATMAP_SIZE; ++address)
+    {
+        maxCount[0] = std::max(maxCount[0], heatmap.Writes[address]);
+        maxCount[1] = std::max(maxCount[1], heatmap.Reads[address]);
+        maxCount[2] = std::max(maxCount[2], heatmap.Executes[address]);
+        if (heatmap.Writes[address] > 0 && heatmap.Executes[address] > 0)
+        {
+            selfModifying++;
+        }
+    }
+    const auto intensity = [](uint32_t count, uint32_t max)
+    {
+        return static_cast<int>(255.0 * std::log1p(count) / std::log1p(max));
+    };
+
+    ImGui::Text("Red: writes, green: reads, blue: executes");
+    ImGui::Text("%zu written and executed (outlined)", selfModifying);
+
+    auto drawList = ImGui::GetWindowDrawList();
+    const auto origin = ImGui::GetCursorScreenPos();
+    for (size_t address = 0; address < SKChip8::HEATMAP_SIZE; ++address)
+    {
+        const ImVec2 min(origin.x + (address % COLUMNS) * CELL_SIZE, origin.y + (address / COLUMNS) * CELL_SIZE);
+        const ImVec2 max(min.x + CELL_SIZE, min.y + CELL_SIZE);
+        drawList->AddRectFilled(min, max, IM_COL32(intensity(heatmap.Writes[address], maxCount[0]),
+                                                   intensity(heatmap.Reads[address], maxCount[1]),
+                                                   intensity(heatmap.Executes[address], maxCount[2]), 255));
+        if (heatmap.Writes[address] > 0 && heatmap.Executes[address] > 0)
+        {
+            drawList->AddRect(min, max, IM_COL32(255, 255, 0, 255));
+        }
+    }
 
-    const auto &cpu = emulator_->GetCPU();
-    auto memory = cpu->GetMemory();
+    const auto rows = SKChip8::HEATMAP_SIZE / COLUMNS;
+    ImGui::Dummy(ImVec2(COLUMNS * CELL_SIZE, rows * CELL_SIZE));
+    if (ImGui::IsItemHovered())
+    {
+        const auto mouse = ImGui::GetMousePos();
+        const auto column = std::min<size_t>(static_cast<size_t>((mouse.x - origin.x) / CELL_SIZE), COLUMNS - 1);
+        const auto row = std::min<size_t>(static_cast<size_t>((mouse.y - origin.y) / CELL_SIZE), rows - 1);
+        const auto address = row * COLUMNS + column;
+
+        ImGui::SetTooltip("%03zX\nreads: %u\nwrites: %u\nexecutes: %u", address,
+                          heatmap.Reads[address], heatmap.Writes[address], heatmap.Executes[address]);
+        if (ImGui::IsItemClicked())
+        {
+            memoryEditor_.GotoAddrAndHighlight(address, address + 1);
+        }
+    }
+#else
+    ImGui::Text("Configure with -DSKCHIP8_PROFILING=ON to enable the heatmap");
+#endif
 
-    memoryEditor.DrawWindow("Memory Viewer", memory.data(), memory.size());
+    ImGui::End();
 }
 
 void DebuggingWindow::drawControlPane()
@@ -166,17 +360,43 @@ void DebuggingWindow::drawControlPane()
 
     if (ImGui::Button("Start"))
     {
+        emulator_->CommitRewind(rewindPosition_);
+        rewindPosition_ = 0;
         emulator_->Enable();
     }
 
     if (ImGui::Button("Step"))
     {
+        emulator_->CommitRewind(rewindPosition_);
+        rewindPosition_ = 0;
         emulator_->Step();
     }
 
+    if (emulator_->IsReverseSteppingEnabled())
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Step Back"))
+        {
+            emulator_->Disable();
+            emulator_->StepBack();
+        }
+    }
+
     if (ImGui::Button("Reset"))
     {
         emulator_->Reset();
+        rewindPosition_ = 0;
+    }
+
+    if (ImGui::Button("Save State"))
+    {
+        emulator_->SaveState(quickSave_);
+        hasQuickSave_ = true;
+    }
+
+    if (hasQuickSave_ && ImGui::Button("Load State"))
+    {
+        emulator_->RestoreState(quickSave_);
     }
 
     if (ImGui::Button("Load ROM"))
@@ -192,25 +412,486 @@ void DebuggingWindow::drawControlPane()
 
             emulator_->LoadProgram(rompath);
             emulator_->Reset();
+            rewindPosition_ = 0;
         }
 
         ImGuiFileDialog::Instance()->Close();
     }
 
+    drawRewindControls();
+    drawReverseStepControls();
+
     ImGui::End();
 }
 
+void DebuggingWindow::drawReverseStepControls()
+{
+    ImGui::Separator();
+
+    bool enabled = emulator_->IsReverseSteppingEnabled();
+    if (ImGui::Checkbox("Reverse Stepping", &enabled))
+    {
+        emulator_->SetReverseSteppingEnabled(enabled);
+    }
+
+    if (!enabled)
+    {
+        return;
+    }
+
+    ImGui::InputText("Break At", reverseTarget_, sizeof(reverseTarget_), ImGuiInputTextFlags_CharsHexadecimal);
+    if (ImGui::Button("Reverse Continue"))
+    {
+        emulator_->Disable();
+        emulator_->ReverseContinue(static_cast<uint16_t>(std::strtoul(reverseTarget_, nullptr, 16)));
+    }
+
+    ImGui::Text("Undo History: %zu instructions", emulator_->GetUndoDepth());
+}
+
+void DebuggingWindow::drawBreakpointPane()
+{
+    ImGui::Begin("Breakpoints");
+
+    auto &breakpoints = emulator_->GetBreakpoints();
+
+    if (emulator_->IsStoppedAtBreakpoint())
+    {
+        const auto &cpu = emulator_->GetCPU();
+        SKChip8::MemoryAccess access;
+        if (breakpoints.FindWatchHit(cpu, &access))
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Stopped at %03X before a %s of %03X-%03X", cpu.GetPC(),
+                               access.Write ? "write" : "read", access.Address, access.Address + access.Size - 1);
+        }
+        else
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Stopped at breakpoint %03X", cpu.GetPC());
+        }
+    }
+
+    ImGui::InputText("Address", breakpointAddress_, sizeof(breakpointAddress_), ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::InputText("Condition", breakpointCondition_, sizeof(breakpointCondition_));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("optional, e.g. V3 == 10, I >= 300, DT != 0 (values in hex)");
+    }
+
+    if (ImGui::Button("Add"))
+    {
+        const auto address = static_cast<uint16_t>(std::strtoul(breakpointAddress_, nullptr, 16));
+        breakpointError_.clear();
+        if (breakpointCondition_[0] == '\0')
+        {
+            breakpoints.Add(address);
+        }
+        else
+        {
+            try
+            {
+                breakpoints.Add(address, SKChip8::BreakCondition::Parse(breakpointCondition_));
+            }
+            catch (const std::invalid_argument &e)
+            {
+                breakpointError_ = e.what();
+            }
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear All"))
+    {
+        breakpoints.Clear();
+    }
+
+    if (!breakpointError_.empty())
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", breakpointError_.c_str());
+    }
+
+    // removing invalidates the list, so only remember which one to remove
+    int removeIndex = -1;
+    if (ImGui::BeginTable("BreakpointTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Condition");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        const auto &list = breakpoints.GetBreakpoints();
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            const auto &breakpoint = list[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%03X", breakpoint.Address);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(breakpoint.Conditional ? breakpoint.Condition.ToString().c_str() : "always");
+            ImGui::TableNextColumn();
+            ImGui::PushID(static_cast<int>(i));
+            if (ImGui::SmallButton("Remove"))
+            {
+                removeIndex = static_cast<int>(i);
+            }
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (removeIndex >= 0)
+    {
+        breakpoints.RemoveAt(static_cast<size_t>(removeIndex));
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Watchpoints");
+
+    ImGui::InputText("Watch Address", watchAddress_, sizeof(watchAddress_), ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::InputInt("Bytes", &watchSize_);
+    ImGui::Checkbox("Reads", &watchRead_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Writes", &watchWrite_);
+    ImGui::SameLine();
+    if (ImGui::Button("Add Watch"))
+    {
+        breakpointError_.clear();
+        try
+        {
+            const auto address = static_cast<uint16_t>(std::strtoul(watchAddress_, nullptr, 16));
+            breakpoints.AddWatch(address, static_cast<uint16_t>(std::max(watchSize_, 0)), watchRead_, watchWrite_);
+        }
+        catch (const std::invalid_argument &e)
+        {
+            breakpointError_ = e.what();
+        }
+    }
+
+    removeIndex = -1;
+    if (ImGui::BeginTable("WatchpointTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Range");
+        ImGui::TableSetupColumn("On");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        const auto &list = breakpoints.GetWatchpoints();
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            const auto &watchpoint = list[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%03X-%03X", watchpoint.Address, watchpoint.Address + watchpoint.Size - 1);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(watchpoint.Read && watchpoint.Write ? "read/write" : watchpoint.Read ? "read" : "write");
+            ImGui::TableNextColumn();
+            ImGui::PushID(static_cast<int>(i));
+            if (ImGui::SmallButton("Remove"))
+            {
+                removeIndex = static_cast<int>(i);
+            }
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (removeIndex >= 0)
+    {
+        breakpoints.RemoveWatchAt(static_cast<size_t>(removeIndex));
+    }
+
+    ImGui::End();
+}
+
+void DebuggingWindow::drawRewindControls()
+{
+    const int frameCount = static_cast<int>(emulator_->GetRewindFrameCount());
+    if (frameCount == 0)
+    {
+        return;
+    }
+
+    ImGui::Separator();
+
+    // the slider runs from the oldest frame on the left to live on the right
+    int sliderPosition = frameCount - 1 - rewindPosition_;
+    if (ImGui::SliderInt("Rewind", &sliderPosition, 0, frameCount - 1))
+    {
+        emulator_->Disable();
+        rewindPosition_ = frameCount - 1 - sliderPosition;
+        emulator_->RewindTo(rewindPosition_);
+    }
+
+    // rewinds one frame per UI frame while held and resumes on release
+    ImGui::Button("Hold to Rewind");
+    if (ImGui::IsItemActive())
+    {
+        emulator_->Disable();
+        rewindPosition_ = std::min(rewindPosition_ + 1, frameCount - 1);
+        emulator_->RewindTo(rewindPosition_);
+    }
+    else if (ImGui::IsItemDeactivated())
+    {
+        emulator_->CommitRewind(rewindPosition_);
+        rewindPosition_ = 0;
+        emulator_->Enable();
+    }
+
+    ImGui::Text("History: %d frames", frameCount);
+}
+
 void DebuggingWindow::drawEmulatorInfoPane()
 {
     ImGui::Begin("Emulator Info");
 
+    const auto &timer = emulator_->GetFrameTimer();
+    auto frameStats = timer.GetFrameStats();
+
     ImGui::Text("Instructions Per Tick: %d", emulator_->GetIPT());
-    ImGui::Text("Frames Per Second: %f", emulator_->GetFPS());
     ImGui::Text("Instructions Per Frame: %f", emulator_->GetInstructionsPerFrame());
+    ImGui::Text("Frame Time: %.2f ms p50, %.2f ms p99 (%.1f FPS)", frameStats.P50, frameStats.P99,
+                frameStats.P50 > 0.0f ? 1000.0f / frameStats.P50 : 0.0f);
+
+    char overlay[32];
+    std::snprintf(overlay, sizeof(overlay), "max %.2f ms", frameStats.Max);
+    ImGui::PlotLines("##frametime", timer.GetFrameHistory(), (int)timer.GetSampleCount(), (int)timer.GetHistoryOffset(),
+                     overlay, 0.0f, std::max(frameStats.Max, 33.3f), ImVec2(0, 60));
+
+    ImGui::Text("Last %d frames (ms)", (int)timer.GetSampleCount());
+    if (ImGui::BeginTable("phases", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+
+        auto row = [](const char *name, const FrameTimer::Stats &stats) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.P50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.P95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.P99);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.Max);
+        };
+
+        for (size_t i = 0; i < FrameTimer::PHASE_COUNT; i++)
+        {
+            auto phase = static_cast<FramePhase>(i);
+            row(FrameTimer::PhaseName(phase), timer.GetStats(phase));
+        }
+        row("Frame", frameStats);
+
+        ImGui::EndTable();
+    }
+
+    // timeline of the front end threads, open in ui.perfetto.dev
+    bool tracing = EventTracer::IsEnabled();
+    if (ImGui::Checkbox("Event Tracing", &tracing))
+    {
+        EventTracer::SetEnabled(tracing);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump Trace"))
+    {
+        if (!EventTracer::Dump("trace.json"))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write trace.json");
+        }
+    }
 
     ImGui::End();
 }
 
+void DebuggingWindow::drawProfilerPane()
+{
+    ImGui::Begin("Profiler");
+
+#ifdef SKCHIP8_PROFILING
+    const auto &profile = emulator_->GetCPU().GetProfile();
+
+    if (ImGui::Button("Clear"))
+    {
+        emulator_->ClearProfile();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+    {
+        std::ofstream csv("profile.csv");
+        profile.WriteCSV(csv);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Stacks"))
+    {
+        std::ofstream folded("callgraph.folded");
+        emulator_->GetCPU().GetCallGraph().WriteCollapsed(folded);
+    }
+
+    static const char *views[] = {"Opcode Classes", "Hot Addresses", "Subroutines"};
+    ImGui::Combo("View", &profilerView_, views, 3);
+
+    if (profilerView_ == 2)
+    {
+        drawCallGraphTable();
+        ImGui::End();
+        return;
+    }
+
+    const auto total = std::max<uint64_t>(profile.GetTotalCount(), 1);
+    ImGui::Text("%llu instructions profiled", static_cast<unsigned long long>(profile.GetTotalCount()));
+
+    // rows are (id, count, nanoseconds), the time column is empty per address
+    struct Row
+    {
+        size_t Id;
+        uint64_t Count;
+        uint64_t Nanoseconds;
+    };
+    std::vector<Row> rows;
+    if (profilerView_ == 0)
+    {
+        for (size_t opcodeClass = 0; opcodeClass < SKChip8::OPCODE_CLASS_COUNT; ++opcodeClass)
+        {
+            rows.push_back(Row{opcodeClass, profile.ClassCounts[opcodeClass], profile.ClassNanoseconds[opcodeClass]});
+        }
+    }
+    else
+    {
+        for (size_t pc = 0; pc < profile.PCCounts.size(); ++pc)
+        {
+            if (profile.PCCounts[pc] > 0)
+            {
+                rows.push_back(Row{pc, profile.PCCounts[pc], 0});
+            }
+        }
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("ProfileTable", 4, flags))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn(profilerView_ == 0 ? "Class" : "Address");
+        ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Share", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("ns/op", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableHeadersRow();
+
+        // the table is rebuilt every frame anyway, so sort every frame too
+        const auto sortSpecs = ImGui::TableGetSortSpecs();
+        if (sortSpecs && sortSpecs->SpecsCount > 0)
+        {
+            const auto column = sortSpecs->Specs[0].ColumnIndex;
+            const bool ascending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+            std::sort(rows.begin(), rows.end(), [column, ascending](const Row &a, const Row &b)
+                      {
+                          double keyA = static_cast<double>(a.Id);
+                          double keyB = static_cast<double>(b.Id);
+                          if (column == 1 || column == 2)
+                          {
+                              keyA = static_cast<double>(a.Count);
+                              keyB = static_cast<double>(b.Count);
+                          }
+                          else if (column == 3)
+                          {
+                              keyA = a.Count ? static_cast<double>(a.Nanoseconds) / a.Count : 0.0;
+                              keyB = b.Count ? static_cast<double>(b.Nanoseconds) / b.Count : 0.0;
+                          }
+                          return ascending ? keyA < keyB : keyA > keyB;
+                      });
+        }
+
+        for (const auto &row : rows)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (profilerView_ == 0)
+            {
+                ImGui::Text("%zX %s", row.Id, SKChip8::ExecutionProfile::ClassName(row.Id));
+            }
+            else
+            {
+                ImGui::Text("%03zX", row.Id);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(row.Count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f%%", 100.0 * row.Count / total);
+            ImGui::TableNextColumn();
+            if (profilerView_ == 0 && row.Count > 0)
+            {
+                ImGui::Text("%.1f", static_cast<double>(row.Nanoseconds) / row.Count);
+            }
+        }
+
+        ImGui::EndTable();
+    }
+#else
+    ImGui::Text("Configure with -DSKCHIP8_PROFILING=ON to enable the profiler");
+#endif
+
+    ImGui::End();
+}
+
+#ifdef SKCHIP8_PROFILING
+void DebuggingWindow::drawCallGraphTable()
+{
+    auto stats = emulator_->GetCPU().GetCallGraph().GetSubroutineStats();
+    const auto total = std::max<uint64_t>(emulator_->GetCPU().GetCallGraph().GetTotalCycles(), 1);
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("CallGraphTable", 5, flags))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Subroutine");
+        ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Inclusive", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Exclusive", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Per Call", ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableHeadersRow();
+
+        using Stats = SKChip8::CallGraphProfile::SubroutineStats;
+        const auto perCall = [](const Stats &s) { return s.Calls ? static_cast<double>(s.InclusiveCycles) / s.Calls : 0.0; };
+
+        const auto sortSpecs = ImGui::TableGetSortSpecs();
+        if (sortSpecs && sortSpecs->SpecsCount > 0)
+        {
+            const auto column = sortSpecs->Specs[0].ColumnIndex;
+            const bool ascending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+            std::sort(stats.begin(), stats.end(), [column, ascending, &perCall](const Stats &a, const Stats &b)
+                      {
+                          double keys[2][5] = {
+                              {double(a.Address), double(a.Calls), double(a.InclusiveCycles), double(a.ExclusiveCycles), perCall(a)},
+                              {double(b.Address), double(b.Calls), double(b.InclusiveCycles), double(b.ExclusiveCycles), perCall(b)}};
+                          return ascending ? keys[0][column] < keys[1][column] : keys[0][column] > keys[1][column];
+                      });
+        }
+
+        for (const auto &row : stats)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%03X", row.Address);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(row.Calls));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu (%.1f%%)", static_cast<unsigned long long>(row.InclusiveCycles), 100.0 * row.InclusiveCycles / total);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu (%.1f%%)", static_cast<unsigned long long>(row.ExclusiveCycles), 100.0 * row.ExclusiveCycles / total);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", perCall(row));
+        }
+
+        ImGui::EndTable();
+    }
+}
+#endif
+
 void DebuggingWindow::initializeWindow()
 {
     // GL 3.0 + GLSL 130
@@ -6,6 +6,7 @@
 #include "SDLEmuAdapter.h"
 
 #include <memory>
+#include <vector>
 
 static constexpr int SCR_WIDTH = 640;
 static constexpr int SCR_HEIGHT = 320;
@@ -47,24 +48,47 @@ void EmulatorWindow::Update()
     if (!display_)
         return;
 
+    EventTracer::Span span("EmulatorWindow::Update");
+
+    auto &timer = emulator_->GetFrameTimer();
     uint64_t start = SDL_GetPerformanceCounter();
 
-    emulator_->UpdateKeyState();
+    {
+        FrameTimer::Scope scope(timer, FramePhase::InputPoll);
+        emulator_->UpdateKeyState();
+    }
 
-    emulator_->Update();
+    {
+        FrameTimer::Scope scope(timer, FramePhase::Emulation);
+        emulator_->Update();
+    }
+
+    std::vector<SDL_Point> frame;
+    {
+        FrameTimer::Scope scope(timer, FramePhase::FrameBufferConversion);
+        frame = emulator_->GetFrameBuffer();
+    }
 
-    auto frame = emulator_->GetFrameBuffer();
+    {
+        FrameTimer::Scope scope(timer, FramePhase::Render);
+        SDL_SetRenderDrawColor(renderer_, 0x00, 0x00, 0x00, 0x00);
+        SDL_RenderClear(renderer_);
+        SDL_SetRenderDrawColor(renderer_, 0xFF, 0xFF, 0xFF, SDL_ALPHA_OPAQUE);
+        SDL_RenderDrawPoints(renderer_, frame.data(), frame.size());
+    }
 
-    SDL_SetRenderDrawColor(renderer_, 0x00, 0x00, 0x00, 0x00);
-    SDL_RenderClear(renderer_);
-    SDL_SetRenderDrawColor(renderer_, 0xFF, 0xFF, 0xFF, SDL_ALPHA_OPAQUE);
-    SDL_RenderDrawPoints(renderer_, frame.data(), frame.size());
-    SDL_RenderPresent(renderer_);
+    {
+        FrameTimer::Scope scope(timer, FramePhase::Present);
+        SDL_RenderPresent(renderer_);
+    }
 
     uint64_t end = SDL_GetPerformanceCounter();
     float elapsed = (end - start) / (float)SDL_GetPerformanceFrequency();
 
-    SDL_Delay(16.666f - elapsed * 1000.0f);
+    {
+        FrameTimer::Scope scope(timer, FramePhase::Sleep);
+        SDL_Delay(16.666f - elapsed * 1000.0f);
+    }
 
     uint64_t end2 = SDL_GetPerformanceCounter();
     float elapsed2 = (end2 - end) / (float)SDL_GetPerformanceFrequency();
@@ -0,0 +1,206 @@
+#include "EventTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // every field is atomic so that a dump racing a writer reads stale or
+    // torn slots without undefined behaviour, the claimed/published counters
+    // below tell which slots can be trusted
+    struct Slot
+    {
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> timestamp;
+        std::atomic<uint64_t> value;
+        std::atomic<bool> counter;
+    };
+
+    struct Ring
+    {
+        Ring(uint32_t id) : tid(id), threadName(nullptr), slots(new Slot[EventTracer::RING_SIZE]), claimed(0), published(0) {}
+
+        uint32_t tid;
+        std::atomic<const char *> threadName;
+        std::unique_ptr<Slot[]> slots;
+        // claimed is bumped before a slot is written, published after
+        std::atomic<uint64_t> claimed;
+        std::atomic<uint64_t> published;
+    };
+
+    struct Event
+    {
+        const char *name;
+        uint64_t timestamp;
+        uint64_t value;
+        bool counter;
+    };
+
+    // rings outlive their threads so that a dump still sees them
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<Ring>> registry;
+
+    Ring &threadRing()
+    {
+        thread_local std::shared_ptr<Ring> ring;
+        if (!ring)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            ring = std::make_shared<Ring>(static_cast<uint32_t>(registry.size() + 1));
+            registry.push_back(ring);
+        }
+        return *ring;
+    }
+
+    // copies the events of ring that were not overwritten during the copy
+    std::vector<Event> snapshot(const Ring &ring)
+    {
+        uint64_t end = ring.published.load(std::memory_order_acquire);
+        uint64_t begin = end > EventTracer::RING_SIZE ? end - EventTracer::RING_SIZE : 0;
+
+        std::vector<Event> events;
+        events.reserve(end - begin);
+        for (uint64_t i = begin; i < end; i++)
+        {
+            const auto &slot = ring.slots[i % EventTracer::RING_SIZE];
+            events.push_back({slot.name.load(std::memory_order_relaxed),
+                              slot.timestamp.load(std::memory_order_relaxed),
+                              slot.value.load(std::memory_order_relaxed),
+                              slot.counter.load(std::memory_order_relaxed)});
+        }
+
+        // a slot is rewritten by the write RING_SIZE later, drop every slot
+        // a writer may have started on since
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t claimed = ring.claimed.load(std::memory_order_relaxed);
+        if (claimed > begin + EventTracer::RING_SIZE)
+        {
+            size_t stale = std::min<uint64_t>(claimed - EventTracer::RING_SIZE - begin, events.size());
+            events.erase(events.begin(), events.begin() + stale);
+        }
+
+        return events;
+    }
+
+    void writeString(std::ostream &out, const char *str)
+    {
+        out << '"';
+        for (; str && *str; str++)
+        {
+            if (*str == '"' || *str == '\\')
+            {
+                out << '\\';
+            }
+            out << *str;
+        }
+        out << '"';
+    }
+
+    // Chrome wants microseconds
+    void writeMicroseconds(std::ostream &out, uint64_t ns)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%llu.%03llu", (unsigned long long)(ns / 1000), (unsigned long long)(ns % 1000));
+        out << buffer;
+    }
+}
+
+std::atomic<bool> EventTracer::enabled_(false);
+
+void EventTracer::SetThreadName(const char *name)
+{
+    threadRing().threadName.store(name, std::memory_order_relaxed);
+}
+
+uint64_t EventTracer::Now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::now() - epoch;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() + 1;
+}
+
+void EventTracer::record(const char *name, uint64_t timestamp, uint64_t value, bool counter)
+{
+    auto &ring = threadRing();
+
+    // only this thread writes its ring
+    uint64_t index = ring.published.load(std::memory_order_relaxed);
+    ring.claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto &slot = ring.slots[index % RING_SIZE];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.counter.store(counter, std::memory_order_relaxed);
+
+    ring.published.store(index + 1, std::memory_order_release);
+}
+
+void EventTracer::WriteJSON(std::ostream &out)
+{
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings = registry;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&]() {
+        if (!first)
+        {
+            out << ",\n";
+        }
+        first = false;
+    };
+
+    for (const auto &ring : rings)
+    {
+        if (auto name = ring->threadName.load(std::memory_order_relaxed))
+        {
+            separate();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+            writeString(out, name);
+            out << "}}";
+        }
+
+        for (const auto &event : snapshot(*ring))
+        {
+            separate();
+            out << "{\"name\":";
+            writeString(out, event.name);
+            out << ",\"ph\":\"" << (event.counter ? 'C' : 'X') << "\",\"pid\":1,\"tid\":" << ring->tid << ",\"ts\":";
+            writeMicroseconds(out, event.timestamp);
+            if (event.counter)
+            {
+                out << ",\"args\":{\"value\":" << static_cast<int64_t>(event.value) << "}}";
+            }
+            else
+            {
+                out << ",\"dur\":";
+                writeMicroseconds(out, event.value);
+                out << "}";
+            }
+        }
+    }
+
+    out << "]}\n";
+}
+
+bool EventTracer::Dump(const std::string &path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        return false;
+    }
+
+    WriteJSON(out);
+    return static_cast<bool>(out);
+}
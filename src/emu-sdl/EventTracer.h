@@ -0,0 +1,68 @@
+#ifndef EVENT_TRACER_H_
+#define EVENT_TRACER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// span and counter tracing for the front end. Every thread writes into its
+// own ring without taking a lock, the rings are merged into Chrome trace
+// event JSON (chrome://tracing, ui.perfetto.dev) when dumped. Names must be
+// string literals, only the pointer is stored
+class EventTracer
+{
+public:
+    // events kept per thread, older ones are overwritten
+    static constexpr size_t RING_SIZE = 1 << 16;
+
+    // times the enclosing scope
+    class Span
+    {
+    public:
+        explicit Span(const char *name) : name_(name), start_(IsEnabled() ? Now() : 0) {}
+        ~Span()
+        {
+            if (start_ != 0)
+            {
+                record(name_, start_, Now() - start_, false);
+            }
+        }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *name_;
+        uint64_t start_;
+    };
+
+    static void Counter(const char *name, int64_t value)
+    {
+        if (IsEnabled())
+        {
+            record(name, Now(), static_cast<uint64_t>(value), true);
+        }
+    }
+
+    static void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // labels the calling thread's track in the timeline
+    static void SetThreadName(const char *name);
+
+    // nanoseconds since the tracer started, never 0
+    static uint64_t Now();
+
+    // merges every thread's ring, safe to call while other threads trace
+    static void WriteJSON(std::ostream &out);
+    // false if path could not be written
+    static bool Dump(const std::string &path);
+
+private:
+    static void record(const char *name, uint64_t timestamp, uint64_t value, bool counter);
+
+    static std::atomic<bool> enabled_;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "FrameTimer.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameTimer::FrameTimer()
+    : next_(0), count_(0), frameStart_(SDL_GetPerformanceCounter()),
+      msPerTick_(1000.0f / SDL_GetPerformanceFrequency())
+{
+    pending_.fill(0);
+    for (auto &window : samples_)
+    {
+        window.fill(0.0f);
+    }
+    frameSamples_.fill(0.0f);
+}
+
+void FrameTimer::EndFrame()
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    for (size_t i = 0; i < PHASE_COUNT; i++)
+    {
+        samples_[i][next_] = pending_[i] * msPerTick_;
+        pending_[i] = 0;
+    }
+    frameSamples_[next_] = (now - frameStart_) * msPerTick_;
+    frameStart_ = now;
+
+    next_ = (next_ + 1) % WINDOW;
+    count_ = std::min(count_ + 1, WINDOW);
+}
+
+FrameTimer::Stats FrameTimer::computeStats(const Window &window) const
+{
+    if (count_ == 0)
+    {
+        return {0.0f, 0.0f, 0.0f, 0.0f};
+    }
+
+    // until the window fills the valid samples are the first count_ slots
+    Window sorted = window;
+    std::sort(sorted.begin(), sorted.begin() + count_);
+
+    // nearest rank
+    auto percentile = [&](float p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * count_));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    };
+
+    return {percentile(0.50f), percentile(0.95f), percentile(0.99f), sorted[count_ - 1]};
+}
+
+const char *FrameTimer::PhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::InputPoll:
+        return "Input Poll";
+    case FramePhase::Emulation:
+        return "Emulation";
+    case FramePhase::FrameBufferConversion:
+        return "Framebuffer Conversion";
+    case FramePhase::Render:
+        return "Render";
+    case FramePhase::Present:
+        return "Present";
+    case FramePhase::Sleep:
+        return "Sleep";
+    case FramePhase::DebuggerUI:
+        return "Debugger UI";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef FRAME_TIMER_H_
+#define FRAME_TIMER_H_
+
+#include "SDL.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// the phases of one trip around the main loop, in the order they run
+enum class FramePhase
+{
+    InputPoll,
+    Emulation,
+    FrameBufferConversion,
+    Render,
+    Present,
+    Sleep,
+    DebuggerUI,
+    Count
+};
+
+// times every phase of a frame and keeps the last WINDOW frames of each so
+// that the debugger can show percentiles instead of a single noisy number
+class FrameTimer
+{
+public:
+    static constexpr size_t PHASE_COUNT = static_cast<size_t>(FramePhase::Count);
+    static constexpr size_t WINDOW = 240;
+
+    struct Stats
+    {
+        float P50;
+        float P95;
+        float P99;
+        float Max;
+    };
+
+    // adds the time until it goes out of scope to phase
+    class Scope
+    {
+    public:
+        Scope(FrameTimer &timer, FramePhase phase) : timer_(timer), phase_(phase), start_(SDL_GetPerformanceCounter()) {}
+        ~Scope() { timer_.Add(phase_, SDL_GetPerformanceCounter() - start_); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        FrameTimer &timer_;
+        FramePhase phase_;
+        uint64_t start_;
+    };
+
+    FrameTimer();
+
+    // a phase can run several times in a frame (event polling), so the ticks
+    // accumulate until EndFrame
+    void Add(FramePhase phase, uint64_t ticks) { pending_[static_cast<size_t>(phase)] += ticks; }
+    // closes the frame, recording every phase and the whole frame period
+    void EndFrame();
+
+    // all times are in milliseconds over the last GetSampleCount() frames
+    Stats GetStats(FramePhase phase) const { return computeStats(samples_[static_cast<size_t>(phase)]); }
+    Stats GetFrameStats() const { return computeStats(frameSamples_); }
+    size_t GetSampleCount() const { return count_; }
+
+    // ring of frame periods for plotting, oldest sample at GetHistoryOffset()
+    const float *GetFrameHistory() const { return frameSamples_.data(); }
+    size_t GetHistoryOffset() const { return count_ < WINDOW ? 0 : next_; }
+
+    static const char *PhaseName(FramePhase phase);
+
+private:
+    using Window = std::array<float, WINDOW>;
+
+    Stats computeStats(const Window &window) const;
+
+    std::array<uint64_t, PHASE_COUNT> pending_;
+    std::array<Window, PHASE_COUNT> samples_;
+    Window frameSamples_;
+    size_t next_;
+    size_t count_;
+    uint64_t frameStart_;
+    float msPerTick_;
+};
+
+#endif
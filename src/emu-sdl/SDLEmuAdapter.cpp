@@ -1,6 +1,8 @@
 #include "SDLEmuAdapter.h"
 
 #include <map>
+#include <memory>
+#include <random>
 
 static constexpr std::pair<SDL_Scancode, uint8_t> KEYMAP[SKChip8::KEY_COUNT] = {
     {SDL_SCANCODE_1, 0x1},
@@ -20,6 +22,13 @@ static constexpr std::pair<SDL_Scancode, uint8_t> KEYMAP[SKChip8::KEY_COUNT] = {
     {SDL_SCANCODE_C, 0xB},
     {SDL_SCANCODE_V, 0xF}};
 
+void SDLEmuAdapter::LoadProgram(const std::string &rompath)
+{
+    EventTracer::Span span("Load ROM");
+    SKChip8::Emulator::LoadProgram(rompath);
+    ROMPath_ = rompath;
+}
+
 std::vector<SDL_Point> SDLEmuAdapter::GetFrameBuffer()
 {
     std::vector<SDL_Point> points;
@@ -45,10 +54,16 @@ void SDLEmuAdapter::UpdateKeyState()
     // transform the keymap from SDL to Chip8
     for (auto &kv : KEYMAP)
     {
-        SetKeyState(kv.second, keyState[kv.first]);
+        SetKeyState(kv.second, keyState[kv.first] || ((remoteKeys_ >> kv.second) & 1));
     }
 }
 
+void SDLEmuAdapter::SetRemoteKeyMask(uint16_t mask)
+{
+    remoteKeys_ = mask;
+    UpdateKeyState();
+}
+
 void SDLEmuAdapter::SetFPS(double fps)
 {
     fps_ = fps;
@@ -58,6 +73,8 @@ void SDLEmuAdapter::SetFPS(double fps)
 void SDLEmuAdapter::Enable()
 {
     running_ = true;
+    stoppedAtBreakpoint_ = false;
+    resuming_ = true;
 }
 
 void SDLEmuAdapter::Disable()
@@ -69,18 +86,161 @@ void SDLEmuAdapter::Update()
 {
     if (running_)
     {
+        EventTracer::Span span("Emulation Batch");
+        EventTracer::Counter("Instructions Per Frame", instructionsPerFrame_);
+
+        // input only changes between frames, so this catches every change
+        movieRecorder_.Observe(*this);
+
+        // only pay for the breakpoint check while there are breakpoints
+        const bool checked = !breakpoints_.Empty();
         for (int i = 0; i < instructionsPerFrame_; ++i)
         {
-            SKChip8::Emulator::Step();
+            // the instruction a breakpoint stopped at runs when resumed
+            if (checked && !resuming_ && breakpoints_.ShouldBreak(chip8CPU_))
+            {
+                running_ = false;
+                stoppedAtBreakpoint_ = true;
+                break;
+            }
+            resuming_ = false;
+
+            stepInstruction();
 
-            if (chip8CPU_->GetSoundTimer() > 0)
+            if (chip8CPU_.GetSoundTimer() > 0)
             {
                 tonePlayer_.Play();
             }
-            else if (chip8CPU_->GetSoundTimer() == 0)
+            else if (chip8CPU_.GetSoundTimer() == 0)
             {
                 tonePlayer_.Pause();
             }
         }
+
+        rewindBuffer_.Capture(*this);
+
+#ifdef SKCHIP8_PROFILING
+        // the heatmap halves about every half second so it follows the program
+        if (++heatmapFrames_ % 30 == 0)
+        {
+            chip8CPU_.DecayHeatmap();
+        }
+#endif
+    }
+
+    // also while stopped, so that stepping from the debugger shows up
+    snapshots_.Publish(*this);
+}
+
+void SDLEmuAdapter::Reset()
+{
+    SKChip8::Emulator::Reset();
+    rewindBuffer_.Clear();
+    undoJournal_.Clear();
+
+    if (movieRecorder_.IsRecording())
+    {
+        movieRecorder_.Begin(*this, movieSeed_);
+    }
+}
+
+bool SDLEmuAdapter::RewindTo(size_t framesBack)
+{
+    undoJournal_.Clear();
+    return rewindBuffer_.Seek(framesBack, *this);
+}
+
+void SDLEmuAdapter::CommitRewind(size_t framesBack)
+{
+    rewindBuffer_.Truncate(framesBack);
+
+    // rewound states are all from this recording, so going back to one only
+    // means forgetting the input recorded after it. not done in RewindTo,
+    // which may just be previewing
+    movieRecorder_.Observe(*this);
+}
+
+void SDLEmuAdapter::RestoreState(const uint8_t *data, size_t size)
+{
+    if (movieRecorder_.IsRecording())
+    {
+        // don't end the recording for a state that won't load
+        std::make_unique<SKChip8::Emulator>()->LoadState(data, size);
+        StopRecording();
+    }
+
+    // throws before touching anything if the state is invalid
+    LoadState(data, size);
+    undoJournal_.Clear();
+}
+
+void SDLEmuAdapter::Step()
+{
+    // the keys may have changed since the last step
+    movieRecorder_.Observe(*this);
+    stepInstruction();
+}
+
+void SDLEmuAdapter::stepInstruction()
+{
+    if (journalEnabled_)
+    {
+        StepJournaled(undoJournal_);
+    }
+    else
+    {
+        SKChip8::Emulator::Step();
+    }
+}
+
+bool SDLEmuAdapter::StepBack()
+{
+    if (!SKChip8::Emulator::StepBack(undoJournal_))
+    {
+        return false;
+    }
+
+    movieRecorder_.Observe(*this);
+    return true;
+}
+
+size_t SDLEmuAdapter::ReverseContinue(uint16_t address)
+{
+    size_t undone = 0;
+    while (StepBack())
+    {
+        undone++;
+        if (chip8CPU_.GetPC() == address || breakpoints_.ShouldBreak(chip8CPU_))
+        {
+            break;
+        }
+    }
+    return undone;
+}
+
+void SDLEmuAdapter::SetReverseSteppingEnabled(bool enabled)
+{
+    journalEnabled_ = enabled;
+    if (!enabled)
+    {
+        undoJournal_.Clear();
+    }
+}
+
+void SDLEmuAdapter::StartRecording(const std::string &path)
+{
+    moviePath_ = path;
+    movieSeed_ = std::random_device()();
+    // Begin resets the machine, nothing from before it can be returned to
+    rewindBuffer_.Clear();
+    undoJournal_.Clear();
+    movieRecorder_.Begin(*this, movieSeed_);
+}
+
+void SDLEmuAdapter::StopRecording()
+{
+    if (movieRecorder_.IsRecording())
+    {
+        movieRecorder_.Finish(*this).Save(moviePath_);
     }
 }
\ No newline at end of file
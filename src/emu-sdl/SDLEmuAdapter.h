@@ -2,10 +2,15 @@
 #define SDL_EMU_ADAPTER_H
 
 #include "SDL.h"
+#include "EventTracer.h"
+#include "FrameTimer.h"
 #include "TonePlayer.h"
 
 #include <string>
 #include <SKChip8/Emulator/Emulator.h>
+#include <SKChip8/Emulator/Movie.h>
+#include <SKChip8/Emulator/RewindBuffer.h>
+#include <SKChip8/Emulator/StateSnapshot.h>
 
 class SDLEmuAdapter : public SKChip8::Emulator
 {
@@ -14,25 +19,111 @@ public:
     {
         LoadProgram(ROMPath_);
         running_ = false;
+        journalEnabled_ = false;
+        heatmapFrames_ = 0;
+        stoppedAtBreakpoint_ = false;
+        resuming_ = false;
+        remoteKeys_ = 0;
         SetFPS(60);
     }
 
+    // traced so that ROM loads show up on the timeline. this hides the
+    // non-virtual Emulator::LoadProgram, so loads made through an Emulator&
+    // are not traced, load through the adapter
+    void LoadProgram(const std::string &rompath);
+
     std::vector<SDL_Point> GetFrameBuffer();
+    // the keyboard, plus any keys held through SetRemoteKeyMask()
     void UpdateKeyState();
+    // keys held on behalf of a remote client (bit n is key n) until the next
+    // call, pressed along with whatever the keyboard holds
+    void SetRemoteKeyMask(uint16_t mask);
     void Enable();
     void Disable();
     void Update();
+    void Reset();
+
+    // a single instruction, journaled while reverse stepping is enabled
+    void Step();
+    // undoes one journaled instruction, false if there is nothing to undo.
+    // a recording drops the input it had after the instruction undone
+    bool StepBack();
+    // steps back until PC reaches address or a breakpoint, or the journal
+    // runs out. returns the number of instructions undone
+    size_t ReverseContinue(uint16_t address);
+
+    // the state as of the end of the last Update(), for the debugger
+    SKChip8::SnapshotPublisher::View AcquireSnapshot() const { return snapshots_.Acquire(); }
+
+    // checked before every instruction while running, Step() ignores them
+    SKChip8::BreakpointSet &GetBreakpoints() { return breakpoints_; }
+    const SKChip8::BreakpointSet &GetBreakpoints() const { return breakpoints_; }
+    // true if running stopped at a breakpoint, until the next Enable()
+    bool IsStoppedAtBreakpoint() const { return stoppedAtBreakpoint_; }
+    bool IsRunning() const { return running_; }
+
+    // the undo journal costs a few bytes per instruction, so it is off by default
+    void SetReverseSteppingEnabled(bool enabled);
+    bool IsReverseSteppingEnabled() const { return journalEnabled_; }
+    size_t GetUndoDepth() const { return undoJournal_.GetRecordCount(); }
+    // call after changing the machine behind the journal's back
+    void ClearUndoJournal() { undoJournal_.Clear(); }
+    // loads a state that need not come from the current timeline, e.g. a
+    // quick save. ends a recording first, since replay could not reach it
+    void RestoreState(const SKChip8::Emulator::SaveStateBuffer &state) { RestoreState(state.data(), state.size()); }
+    // as above, throws without ending the recording if data isn't a valid state
+    void RestoreState(const uint8_t *data, size_t size);
     void SetFPS(double fps);
 
+    // rewind history, captured once per frame while running
+    size_t GetRewindFrameCount() const { return rewindBuffer_.GetFrameCount(); }
+    // shows the state framesBack frames ago without discarding newer frames
+    bool RewindTo(size_t framesBack);
+    // discards the frames newer than framesBack so that running continues
+    // from there. a recording drops the input it had after that frame
+    void CommitRewind(size_t framesBack);
+
+    // records input from a fresh reset until StopRecording() writes the movie
+    // to path. Reset() restarts the recording, RestoreState() ends it
+    void StartRecording(const std::string &path);
+    void StopRecording();
+    bool IsRecording() const { return movieRecorder_.IsRecording(); }
+
+#ifdef SKCHIP8_PROFILING
+    void ClearProfile() { chip8CPU_.ClearProfile(); }
+#endif
+
     double GetFPS() const { return fps_; }
     double GetInstructionsPerFrame() const { return instructionsPerFrame_; }
 
+    // shared by the main loop and both windows, each times its own phases
+    FrameTimer &GetFrameTimer() { return frameTimer_; }
+    const FrameTimer &GetFrameTimer() const { return frameTimer_; }
+
 private:
+    // Step() without observing input, for the frame loop which observes once per frame
+    void stepInstruction();
+
     TonePlayer tonePlayer_;
+    FrameTimer frameTimer_;
+    SKChip8::RewindBuffer rewindBuffer_;
+    SKChip8::SnapshotPublisher snapshots_;
+    SKChip8::UndoJournal undoJournal_;
+    bool journalEnabled_;
+    SKChip8::MovieRecorder movieRecorder_;
+    std::string moviePath_;
+    uint32_t movieSeed_;
     std::string ROMPath_;
     bool running_;
+    SKChip8::BreakpointSet breakpoints_;
+    bool stoppedAtBreakpoint_;
+    // set by Enable() so that the first instruction skips the breakpoint check
+    bool resuming_;
+    uint16_t remoteKeys_;
     uint64_t instructionsPerFrame_;
     double fps_;
+    // frames run, the heatmap decays every 30th
+    uint64_t heatmapFrames_;
 };
 
 #endif
\ No newline at end of file
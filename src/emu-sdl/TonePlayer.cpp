@@ -1,4 +1,5 @@
 #include "TonePlayer.h"
+#include "EventTracer.h"
 
 #include <cmath>
 #include <numeric>
@@ -9,6 +10,13 @@ namespace
     static constexpr float SAMPLE_RATE = 44100.0f;
     void audio_callback(void *userdata, Uint8 *stream, int len)
     {
+        if (EventTracer::IsEnabled())
+        {
+            EventTracer::SetThreadName("Audio");
+        }
+        EventTracer::Span span("TonePlayer Callback");
+        EventTracer::Counter("Audio Buffer Bytes", len);
+
         auto tone_player = (TonePlayer *)userdata;
         tone_player->GenerateSamples(stream, len);
     }
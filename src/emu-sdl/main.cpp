@@ -5,13 +5,80 @@
 #include <SKChip8/Core/CPU.h>
 #include <SKChip8/Utils/ROMLoader.h>
 
+#ifdef SKCHIP8_DEBUG_SERVER
+#include <SKChip8/Debug/DebugServer.h>
+#endif
+
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "glad/glad.h"
 
 #include "DebuggingWindow.hpp"
 #include "EmulatorWindow.hpp"
 
+#ifdef SKCHIP8_DEBUG_SERVER
+namespace
+{
+    // remote requests go through the adapter like the debugger's buttons do,
+    // so the undo journal, rewind history and recording stay consistent
+    class AdapterDebugTarget : public SKChip8::DebugTarget
+    {
+    public:
+        explicit AdapterDebugTarget(SDLEmuAdapter &emulator) : emulator_(emulator) {}
+
+        SKChip8::Emulator &GetEmulator() override { return emulator_; }
+        SKChip8::BreakpointSet &GetBreakpoints() override { return emulator_.GetBreakpoints(); }
+
+        void LoadProgram(const std::string &path) override
+        {
+            emulator_.LoadProgram(path);
+            emulator_.Reset();
+        }
+        void Reset() override { emulator_.Reset(); }
+
+        uint64_t Run(uint64_t count) override
+        {
+            checkCount(count, "Run");
+            return emulator_.GetBreakpoints().RunUntilBreak(emulator_.GetCPU(), count, [this]
+                                                            { emulator_.Step(); });
+        }
+        void Step(uint64_t count) override
+        {
+            checkCount(count, "Step");
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                emulator_.Step();
+            }
+        }
+
+        void LoadState(const uint8_t *data, size_t size) override { emulator_.RestoreState(data, size); }
+        // held until the next SetKeys, the keyboard would undo a plain SetKeyMask
+        // before the next frame
+        void SetKeyMask(uint16_t mask) override { emulator_.SetRemoteKeyMask(mask); }
+
+    private:
+        // requests run on the UI thread, one journaled and recorded Step() per
+        // instruction, so a huge count would freeze the window
+        static constexpr uint64_t MAX_INSTRUCTIONS_PER_REQUEST = 1000000;
+
+        static void checkCount(uint64_t count, const char *command)
+        {
+            if (count > MAX_INSTRUCTIONS_PER_REQUEST)
+            {
+                throw std::invalid_argument(std::string(command) + " is limited to " +
+                                            std::to_string(MAX_INSTRUCTIONS_PER_REQUEST) + " instructions per request");
+            }
+        }
+
+        SDLEmuAdapter &emulator_;
+    };
+}
+#endif
+
 int main(int argc, char *argv[])
 {
     SDL_Event event;
@@ -24,35 +91,102 @@ int main(int argc, char *argv[])
 
     auto rom = argc < 2 ? "../roms/maze.ch8" : argv[1];
     {
+        std::string recordPath;
+        std::string tracePath;
+        std::string debugServerPath;
+        for (int i = 2; i + 1 < argc; i += 2)
+        {
+            // replay with: SKChip8EmuCLI <rom> --replay <movie>
+            if (std::strcmp(argv[i], "--record") == 0)
+            {
+                recordPath = argv[i + 1];
+            }
+            // Chrome trace JSON of the whole session, written on exit
+            else if (std::strcmp(argv[i], "--trace") == 0)
+            {
+                tracePath = argv[i + 1];
+            }
+            // drive this emulator with SKChip8EmuDebug script <path>
+            else if (std::strcmp(argv[i], "--debug-server") == 0)
+            {
+                debugServerPath = argv[i + 1];
+            }
+        }
+
+        // before the emulator exists, so that the startup ROM load is traced
+        EventTracer::SetThreadName("Main");
+        EventTracer::SetEnabled(!tracePath.empty());
+
         auto emulator = std::make_shared<SDLEmuAdapter>(rom);
+        if (!recordPath.empty())
+        {
+            emulator->StartRecording(recordPath);
+        }
+
+#ifdef SKCHIP8_DEBUG_SERVER
+        AdapterDebugTarget debugTarget(*emulator);
+        std::unique_ptr<SKChip8::DebugServer> debugServer;
+        if (!debugServerPath.empty())
+        {
+            debugServer = std::make_unique<SKChip8::DebugServer>(debugServerPath, debugTarget);
+        }
+#else
+        if (!debugServerPath.empty())
+        {
+            std::cerr << "Built without the debug server" << std::endl;
+        }
+#endif
 
         DebuggingWindow debugWindow(emulator);
         EmulatorWindow emulatorWindow(emulator);
 
+        auto &frameTimer = emulator->GetFrameTimer();
+
         bool shouldStop = false;
         while (!shouldStop)
         {
             // handle and dispatch events
-            while (SDL_PollEvent(&event))
             {
-                // TODO(sk00) do this better
-                if (event.window.windowID == debugWindow.GetWindowID())
+                FrameTimer::Scope scope(frameTimer, FramePhase::InputPoll);
+                while (SDL_PollEvent(&event))
                 {
-                    debugWindow.HandleEvent(event);
-                }
-                else if (event.window.windowID == emulatorWindow.GetWindowID())
-                {
-                    emulatorWindow.HandleEvent(event);
-                }
-                else if (event.type == SDL_QUIT)
-                {
-                    shouldStop = true;
-                    break;
+                    // TODO(sk00) do this better
+                    if (event.window.windowID == debugWindow.GetWindowID())
+                    {
+                        debugWindow.HandleEvent(event);
+                    }
+                    else if (event.window.windowID == emulatorWindow.GetWindowID())
+                    {
+                        emulatorWindow.HandleEvent(event);
+                    }
+                    else if (event.type == SDL_QUIT)
+                    {
+                        shouldStop = true;
+                        break;
+                    }
                 }
             }
 
+#ifdef SKCHIP8_DEBUG_SERVER
+            if (debugServer)
+            {
+                debugServer->Pump();
+            }
+#endif
+
             emulatorWindow.Update();
-            debugWindow.Update();
+            {
+                FrameTimer::Scope scope(frameTimer, FramePhase::DebuggerUI);
+                debugWindow.Update();
+            }
+            frameTimer.EndFrame();
+        }
+
+        emulator->StopRecording();
+
+        if (!tracePath.empty() && !EventTracer::Dump(tracePath))
+        {
+            std::cerr << "Couldn't write trace to " << tracePath << std::endl;
         }
     }
 
@@ -0,0 +1,108 @@
+#include <SKChip8/Emulator/Emulator.h>
+#include <SKChip8/Trace/TraceReader.h>
+#include <SKChip8/Trace/TraceWriter.h>
+#include <SKChip8/Utils/CHIP8ISA.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// binary execution traces. record one headless run:
+//   SKChip8EmuTrace record ROM TRACE INSTRUCTIONS [--seed N]
+// and look at the instructions around a cycle:
+//   SKChip8EmuTrace dump TRACE CYCLE [COUNT]
+
+namespace
+{
+    void printUsage(const char *name)
+    {
+        std::cout << "Usage: " << name << " record ROM TRACE INSTRUCTIONS [--seed N]\n"
+                  << "       " << name << " dump TRACE CYCLE [COUNT]" << std::endl;
+    }
+
+    int record(const std::string &rom, const std::string &path, uint64_t instructions, uint32_t seed)
+    {
+        SKChip8::Emulator emulator;
+        emulator.LoadProgram(rom);
+        emulator.SeedRandom(seed);
+
+        SKChip8::TraceWriter writer(path);
+        const auto start = std::chrono::steady_clock::now();
+
+        // in slices so progress can be reported on long traces
+        static constexpr uint64_t SLICE = 100000000;
+        for (uint64_t done = 0; done < instructions;)
+        {
+            const auto slice = std::min(SLICE, instructions - done);
+            SKChip8::RunTraced(emulator, slice, writer);
+            done += slice;
+            if (done < instructions)
+            {
+                std::cout << done << " instructions traced" << std::endl;
+            }
+        }
+        writer.Close();
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto bytes = writer.GetBytesWritten();
+        std::cout << writer.GetRecordCount() << " records, " << bytes << " bytes ("
+                  << static_cast<double>(bytes) / std::max<uint64_t>(writer.GetRecordCount(), 1) << " bytes/record) in "
+                  << elapsed << "s (" << (elapsed > 0 ? instructions / elapsed / 1e6 : 0) << " MIPS)" << std::endl;
+        return 0;
+    }
+
+    int dump(const std::string &path, uint64_t cycle, uint64_t count)
+    {
+        SKChip8::TraceReader reader(path);
+        std::cout << reader.GetRecordCount() << " records in " << reader.GetBlockCount() << " blocks, cycles "
+                  << reader.GetFirstCycle() << "-" << reader.GetLastCycle() << std::endl;
+
+        reader.ForEach(cycle, cycle + count - 1, [](const SKChip8::TraceRecord &record)
+                       {
+                           std::stringstream instruction;
+                           SKChip8::DecodeInstruction(record.Opcode)->dump(instruction);
+
+                           std::cout << std::setw(12) << std::setfill(' ') << std::dec << record.Cycle << "  "
+                                     << std::hex << std::setfill('0') << std::setw(3) << record.PC << "  "
+                                     << std::setw(4) << record.Opcode << "  " << std::left << std::setw(20)
+                                     << std::setfill(' ') << instruction.str() << std::right;
+                           for (size_t reg = 0; reg < SKChip8::REG_COUNT; ++reg)
+                           {
+                               if (record.ChangedRegisters & (1 << reg))
+                               {
+                                   std::cout << " V" << reg << "=" << std::setfill('0') << std::setw(2)
+                                             << static_cast<int>(record.Registers[reg]);
+                               }
+                           }
+                           std::cout << std::dec << std::endl;
+                           return true;
+                       });
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 5 && std::strcmp(argv[1], "record") == 0)
+    {
+        uint32_t seed = 1;
+        if (argc >= 7 && std::strcmp(argv[5], "--seed") == 0)
+        {
+            seed = static_cast<uint32_t>(std::stoul(argv[6]));
+        }
+        return record(argv[2], argv[3], std::stoull(argv[4]), seed);
+    }
+
+    if (argc >= 4 && std::strcmp(argv[1], "dump") == 0)
+    {
+        const uint64_t count = argc >= 5 ? std::stoull(argv[4]) : 32;
+        return dump(argv[2], std::stoull(argv[3]), std::max<uint64_t>(count, 1));
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}